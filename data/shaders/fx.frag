@@ -2,6 +2,7 @@
 
 varying vec2 uv;
 varying vec2 screen;
+varying float vertex_fac;
 
 uniform sampler2D texture;
 
@@ -9,5 +10,5 @@ uniform float fac;
 
 void main(void) {
     vec4 color = texture2D(texture, uv);
-    gl_FragColor = vec4(color * color.a * fac);
+    gl_FragColor = vec4(color * color.a * fac * vertex_fac);
 }
@@ -0,0 +1,25 @@
+#version 110
+
+// world space to screen space, includes aspect ratio, zoom and center.
+uniform mat3 view;
+
+uniform mat3 model;
+
+attribute vec2 in_location;
+attribute vec2 in_uv;
+attribute float in_fac;
+
+varying vec2 uv;
+varying vec2 screen;
+varying float vertex_fac;
+
+void main(void) {
+    vec2 location = vec2(view * model * vec3(in_location, 1.0));
+
+    gl_Position = vec4(location, 0.0, 1.0);
+
+    screen = (location + vec2(1.0, 1.0)) * 0.5;
+
+    uv = in_uv;
+    vertex_fac = in_fac;
+}
@@ -1,8 +1,7 @@
 #version 110
 
-uniform float aspect;
-uniform float zoom;
-uniform vec2 center;
+// world space to screen space, includes aspect ratio, zoom and center.
+uniform mat3 view;
 
 uniform mat3 model;
 
@@ -13,14 +12,7 @@ varying vec2 uv;
 varying vec2 screen;
 
 void main(void) {
-    vec2 location = vec2(model * vec3(in_location, 1.0)) - center;
-    location *= zoom;
-
-    if(aspect > 1.0){
-        location.x /= aspect;
-    }else if(aspect < 1.0){
-        location.y *= aspect;
-    }
+    vec2 location = vec2(view * model * vec3(in_location, 1.0));
 
     gl_Position = vec4(location, 0.0, 1.0);
 
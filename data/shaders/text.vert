@@ -1,6 +1,7 @@
 #version 110
 
-uniform float aspect;
+// corrects for aspect ratio.
+uniform mat3 view_gui;
 uniform vec2 center;
 
 attribute vec2 in_location;
@@ -9,15 +10,7 @@ attribute vec2 in_uv;
 varying vec2 uv;
 
 void main(void) {
-    vec2 location = in_location;
-
-    if(aspect > 1.0){
-        location.x /= aspect;
-    }else if(aspect < 1.0){
-        location.y *= aspect;
-    }
-
-    location += center;
+    vec2 location = vec2(view_gui * vec3(in_location, 1.0)) + center;
 
     gl_Position = vec4(location, 0.0, 1.0);
 
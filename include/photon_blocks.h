@@ -1,14 +1,19 @@
 #ifndef _PHOTON_BLOCKS_H_
 #define _PHOTON_BLOCKS_H_
 
-#include "photon_opengl.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <cmath>
 
 namespace photon{
+struct photon_laserbeam;
 struct photon_lasersegment;
+struct photon_laserhit;
 struct photon_level;
 struct photon_player;
 
-enum block_type{
+// stored in a byte so photon_block stays small.
+enum block_type : int8_t{
     invalid_block = -1,// if there is an error of some kind.
 
     air, // empty space.
@@ -47,29 +52,154 @@ enum block_type{
 
     // moves when activated (no diagonal)
     move,
-    move_reverse
+    move_reverse,
+
+    block_type_count // not a block, the number of block types.
 };
 
 
+// power a receiver needs to count as powered.
+#define PHOTON_RECEIVER_POWERED 0.9f
+
+// block rotations are in steps of 22.5 degrees, counter-clockwise starting from +x.
+#define PHOTON_ROTATION_STEPS 16
+
+// fractional bits of photon_block_power.
+#define PHOTON_POWER_SHIFT 12
+#define PHOTON_POWER_ONE (1 << PHOTON_POWER_SHIFT)
+
+// block power as 4.12 fixed point, acts like a float but saturates at about +-8.
+struct photon_block_power{
+    int16_t value = 0;
+
+    photon_block_power() = default;
+    photon_block_power(float power){
+        *this = power;
+    }
+
+    operator float() const{
+        return float(value) / PHOTON_POWER_ONE;
+    }
+
+    photon_block_power &operator=(float power){
+        float scaled = std::round(power * PHOTON_POWER_ONE);
+        value = scaled >= INT16_MAX ? INT16_MAX : scaled > INT16_MIN ? int16_t(scaled) : INT16_MIN;
+        return *this;
+    }
+
+    photon_block_power &operator+=(float amount){
+        return *this = float(*this) + amount;
+    }
+    photon_block_power &operator-=(float amount){
+        return *this = float(*this) - amount;
+    }
+    photon_block_power operator++(int){
+        photon_block_power old = *this;
+        *this += 1.0f;
+        return old;
+    }
+    photon_block_power operator--(int){
+        photon_block_power old = *this;
+        *this -= 1.0f;
+        return old;
+    }
+};
+
 struct photon_block{
+    photon_block() : rotation(0), locked(0){}
+
     // block type.
     block_type type = air;
 
-    // the angle in degrees of a block, only used by mirrors, emitters & receivers.
-    float angle = 0.0f;
+    // the rotation of a block (see PHOTON_ROTATION_STEPS), only used by mirrors, emitters, receivers & move blocks.
+    uint8_t rotation : 4;
+
+    // if locked you cannot pick it up. (some you cannot pick up at all)
+    uint8_t locked : 1;
+
     // used for various things depending on the block type...
-    float power = 0.0f;
+    photon_block_power power;
+};
 
-    // used to tell if a laser intersected with it last frame.
-    bool activated = false;
+// chunks are arrays of these, keep them small.
+static_assert(sizeof(photon_block) == 4, "photon_block should be 4 bytes");
+
+// textures blocks are drawn with, loaded by blocks::LoadTextures().
+enum block_texture : uint8_t{
+    block_texture_none,
+
+    block_texture_plain,
+    block_texture_indestructible,
+    block_texture_mirror,
+    block_texture_tnt,
+    block_texture_explosion,
+    block_texture_filter_red,
+    block_texture_filter_green,
+    block_texture_filter_blue,
+    block_texture_filter_yellow,
+    block_texture_filter_cyan,
+    block_texture_filter_magenta,
+    block_texture_emitter,
+    block_texture_receiver,
+    block_texture_receiver_fx,
+    block_texture_receiver_fx_red,
+    block_texture_receiver_fx_green,
+    block_texture_receiver_fx_blue,
+    block_texture_target,
+
+    block_texture_count
+};
 
-    // if locked you cannot pick it up. (some you cannot pick up at all)
-    bool locked = false;
+// color channels for photon_block_traits::color_mask.
+#define PHOTON_COLOR_RED    1
+#define PHOTON_COLOR_GREEN  2
+#define PHOTON_COLOR_BLUE   4
+#define PHOTON_COLOR_WHITE  (PHOTON_COLOR_RED | PHOTON_COLOR_GREEN | PHOTON_COLOR_BLUE)
+
+// the things about a block type that don't change, see blocks::GetTraits().
+struct photon_block_traits{
+    block_type type;
+    // name used in level files & scripts.
+    const char *name;
+
+    block_texture texture;
+    // drawn over the block by blocks::DrawFX().
+    block_texture fx_texture;
+    // half the width the block is drawn at.
+    float draw_scale;
+
+    // uses photon_block::rotation, which gets saved & drawn.
+    bool has_rotation;
+    // the player can rotate it.
+    bool rotatable;
+    // the player can pick it up, unless it is locked.
+    bool pickable;
+    // gets destroyed by explosions.
+    bool destructible;
+    // beams end when they reach it.
+    bool stops_beam;
+    // gets blocks::OnLightHit() called when a beam reaches it.
+    bool records_hits;
+    // needs blocks::OnFrame() called every frame.
+    bool needs_frame_update;
+
+    // color emitted, needed or let through. (PHOTON_COLOR_*)
+    uint8_t color_mask;
 };
 
 namespace blocks{
 
-photon_lasersegment* OnLightInteract(photon_lasersegment* segment, glm::uvec2 location, photon_level &level, float time);
+// one entry per block_type, in order.
+extern const photon_block_traits block_traits[block_type_count];
+
+// invalid blocks get the traits of air.
+inline const photon_block_traits &GetTraits(block_type type){
+    return block_traits[type > air && type < block_type_count ? type : air];
+}
+
+photon_lasersegment* OnLightInteract(photon_laserbeam &beam, photon_lasersegment* segment, glm::uvec2 location, const photon_level &level);
+
+void OnLightHit(const photon_laserhit &hit, photon_level &level, float time);
 
 void OnPhotonInteract(glm::uvec2 location, photon_level &level, photon_player &player);
 
@@ -77,21 +207,20 @@ void OnRotate(glm::uvec2 location, photon_level &level, bool counter_clockwise =
 
 void OnRotate(glm::uvec2 location, photon_level &level, float to_angle);
 
-void OnFrame(glm::uvec2 location, photon_level &level, float time);
-
-void OnDamage(glm::uvec2 location, photon_level &level, float damage);
+// rounds an angle in degrees to the nearest rotation step.
+uint8_t DegreesToRotation(float degrees);
 
-void DamageAroundPoint(glm::uvec2 location, photon_level &level, float strength);
-
-// Drawing functions
+void OnFrame(glm::uvec2 location, photon_level &level, float time);
 
-void Draw(photon_block block, glm::vec2 location);
+// true for block types that do something in OnFrame().
+bool NeedsFrameUpdate(block_type type);
 
-void DrawFX(photon_block block, glm::vec2 location);
+// adds a beam to level.beams if the block at location is an emitter.
+void EmitBeam(glm::uvec2 location, photon_level &level);
 
-void LoadTextures();
+void OnDamage(glm::uvec2 location, photon_level &level, float damage);
 
-GLuint GetBlockTexture(block_type type);
+void DamageAroundPoint(glm::uvec2 location, photon_level &level, float strength);
 
 const char* GetBlockName(block_type type);
 
@@ -1,8 +1,7 @@
 #ifndef _PHOTON_CORE_H_
 #define _PHOTON_CORE_H_
 
-#include "photon_player.h"
-#include "photon_level.h"
+#include "photon_sim.h"
 #include "photon_input.h"
 #include "photon_gui.h"
 
@@ -24,6 +23,19 @@ struct photon_settings{
 
     bool screen_edges = true;
 
+    // number of threads used to trace beams, 0 uses one per core.
+    int trace_threads = 1;
+    // most block interactions traced per frame, 0 for no limit.
+    uint32_t trace_budget = 1 << 20;
+
+    // simulation ticks per second, the level always advances in steps of 1 / tick_rate seconds.
+    float tick_rate = 60.0f;
+    // most ticks run per frame, if a frame takes longer the extra time is dropped.
+    int max_ticks = 8;
+
+    // frames that take longer than this many milliseconds are counted in the frame time stats.
+    float frame_budget = 1000.0f / 60.0f;
+
     std::string input_config;
 };
 
@@ -38,6 +50,10 @@ struct photon_instance{
 
     photon_player player;
 
+    photon_timestep timestep;
+
+    photon_frame_stats stats;
+
     photon_gui_container gui;
     bool paused = false;
 
@@ -59,39 +75,12 @@ void GarbageCollect(photon_instance &instance);
 
 void Close(photon_instance &instance);
 
-/*!
- * \brief Prints formated string to log.
- * Prints to both stdout and log file (if open). syntax identical to printf().
- * \param format
- */
-void PrintToLog(const char *format,...);
-
 bool LoadEngineConfig(const std::string &filename, photon_instance &instance);
 
 bool SetRootPhysFS(const std::string &dir, bool do_archives);
 
 bool SetSavesDirPhysFS(const std::string &dir);
 
-/*!
- * \brief holds version information.
- */
-namespace build_info{
-/*!
- * \brief holds the builds git sha1 value.
- */
-extern const char* git_sha1;
-
-/*!
- * \brief holds the build type (as defined in CMake by CMAKE_BUILD_TYPE)
- */
-extern const char* build_type;
-
-/*!
- * \brief version
- */
-extern const char* version;
-}
-
 }
 
 #endif
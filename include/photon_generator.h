@@ -0,0 +1,51 @@
+#ifndef _PHOTON_GENERATOR_H_
+#define _PHOTON_GENERATOR_H_
+
+#include "photon_level.h"
+
+#include <vector>
+
+namespace photon{
+struct photon_player;
+
+// settings for generating a level, the same settings always make the same level.
+struct photon_generator_settings{
+    uint64_t seed = 1;
+
+    // size of the level, not counting the border.
+    uint32_t width = 64;
+    uint32_t height = 64;
+
+    uint32_t emitters = 8;
+    // each emitter is one of these picked at random.
+    std::vector<block_type> emitter_types = { emitter_white };
+
+    // chance of each block being a mirror or a filter, from 0 to 1.
+    float mirror_density = 0.05f;
+    float filter_density = 0.0f;
+
+    uint32_t receivers = 0;
+    uint32_t targets = 0;
+
+    // groups of TNT blocks, each within a square of tnt_cluster_size blocks across.
+    uint32_t tnt_clusters = 0;
+    uint32_t tnt_cluster_size = 3;
+
+    // move blocks, half of them move_reverse.
+    uint32_t move_blocks = 0;
+
+    photon_level::game_mode mode = photon_level::none;
+    // only used by tnt_harvester.
+    int16_t goal = 0;
+};
+
+namespace generator{
+
+// fills level with randomly placed blocks, the player is put in the middle with infinite mirrors.
+void Generate(const photon_generator_settings &settings, photon_level &level, photon_player &player);
+
+}
+
+}
+
+#endif
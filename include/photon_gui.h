@@ -59,8 +59,6 @@ struct photon_gui_game{
     photon_gui_bounds toggle_fullscreen_button = {0.12f, 0.02f, 0.84f, 0.94f, 0.0f, -1.0f};
     GLuint toggle_fullscreen_button_texture = 0;
 
-    std::string message;
-    float message_timeout = INFINITY;
     photon_gui_bounds message_area = {0.7f, 0.4f, -0.3f, 1.0f, 0.0f, -1.0f};
     GLuint message_background_texture = 0;
 
@@ -134,7 +132,8 @@ void ActivateButton(photon_instance &instance, photon_gui_button_list &list, glm
 
 void ActivateButton(photon_instance &instance, photon_gui_button_list &list, int8_t button);
 
-void DrawBounds(const photon_gui_bounds &bounds);
+// uv is the part of the texture to draw: left, top, right, bottom.
+void DrawBounds(const photon_gui_bounds &bounds, const glm::vec4 &uv = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
 
 void DrawButtonText(photon_gui_button &button, bool highlighted, const glm::vec4 &base_color, const glm::vec4 &highlight_color);
 
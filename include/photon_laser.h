@@ -2,51 +2,112 @@
 #define _PHOTON_LASER_H_
 
 #include <glm/glm.hpp>
-#include <list>
+#include <vector>
 
 namespace photon{
+// beams go in one of 8 directions, in steps of 45 degrees counter-clockwise starting from +x.
+// (one direction is 2 block rotation steps)
+#define PHOTON_DIRECTIONS 8
+
 struct photon_lasersegment;
 struct photon_level;
 
+// a block that reacts to a beam every frame it is lit. (receivers, TNT & move blocks)
+struct photon_laserhit{
+    glm::uvec2 location;
+    // direction & color of the segment that hit the block.
+    uint8_t direction;
+    glm::vec3 color;
+};
+
+// a chunk that one of a beam's segments goes through.
+struct photon_laserchunk{
+    // see level::ChunkKey()
+    uint64_t key;
+    // index into the beam's segments.
+    uint32_t segment;
+};
+
+// one segment of one of the level's beams, by index.
+struct photon_segment_ref{
+    uint32_t beam;
+    uint32_t segment;
+};
+
 struct photon_laserbeam{
     glm::uvec2 origin;
-    float origin_angle;
+    uint8_t origin_direction;
 
-    std::list<photon_lasersegment> segments;
+    // segments in the order they were traced, cleared but not freed when retracing.
+    std::vector<photon_lasersegment> segments;
 
     glm::vec3 color;
+
+    // blocks that need blocks::OnLightHit() every frame, in the order they were traced.
+    std::vector<photon_laserhit> hits;
+
+    // chunks each segment passes through, sorted by key.
+    std::vector<photon_laserchunk> chunks;
+
+    // if true the beam gets retraced next frame.
+    bool dirty = true;
+
+    // number of blocks the beam interacted with when it was last traced.
+    uint32_t steps = 0;
+
+    // set if tracing stopped because the beam came back around to somewhere it had already been.
+    bool closed_loop = false;
+    // set if tracing stopped because the steps it was allowed ran out.
+    bool truncated = false;
 };
 
 struct photon_lasersegment{
-    photon_laserbeam &beam;
-    photon_lasersegment *parent = nullptr;
-    photon_lasersegment *child = nullptr;
+    // indices into photon_laserbeam::segments, -1 if there is none.
+    int32_t parent = -1;
+    int32_t child = -1;
 
     glm::uvec2 start;
     glm::uvec2 end;
-    float angle;
+    uint8_t direction;
 
     // seperate from the root color to allow for filters.
     glm::vec3 color;
-
-    photon_lasersegment(photon_laserbeam &Beam) : beam(Beam) {}
 };
 
 namespace tracer{
 
-void TraceBeam(photon_laserbeam& beam, photon_level &level, float time);
+// traces the path of the beam, only reads the level. stops after max_steps interactions unless it is 0.
+void TraceBeam(photon_laserbeam& beam, const photon_level &level, uint32_t max_steps = 0);
 
-photon_lasersegment *CreateChildBeam(photon_lasersegment *parent);
+// traces all the beams, spread across the tracer threads if there are any.
+// the beams share budget interactions between them, the ones still tracing when it runs out are truncated. (0 for no limit)
+void TraceBeams(const std::vector<photon_laserbeam*> &beams, const photon_level &level, uint32_t budget = 0);
 
-}
+// limits the interactions traced per frame, beams that don't fit stay dirty until the next frame. (0 for no limit)
+void SetTraceBudget(uint32_t steps);
+
+uint32_t GetTraceBudget();
+
+// starts the tracer threads, count includes the calling thread. (0 uses one per core, 1 traces everything on the calling thread)
+void InitThreads(int count);
+
+// stops the tracer threads.
+void GarbageCollect();
+
+// calls blocks::OnLightHit() for every block hit when the beam was last traced.
+void ApplyBeam(photon_laserbeam& beam, photon_level &level, float time);
+
+// true if the beam went through location when it was last traced.
+bool PassesThrough(const photon_laserbeam& beam, glm::uvec2 location);
 
-namespace opengl{
+// true if location is one of the blocks the segment covers. (not counting its start, that belongs to the parent segment)
+bool PassesThrough(const photon_lasersegment& segment, glm::uvec2 location);
 
-void DrawLaser(photon_laserbeam &beam);
-void DrawLaserSegment(photon_lasersegment &segment);
+// the offset to the next block going in direction.
+glm::ivec2 GetDirectionStep(uint8_t direction);
 
-void DrawLaserLight(photon_laserbeam &beam);
-void DrawLaserSegmentLight(photon_lasersegment &segment);
+// adds a segment continuing from parent, any other pointers to segments of beam are invalidated.
+photon_lasersegment *CreateChildBeam(photon_laserbeam &beam, photon_lasersegment *parent);
 
 }
 
@@ -4,12 +4,70 @@
 #include "photon_blocks.h"
 #include "photon_laser.h"
 
-#include <map>
+#include <vector>
+#include <set>
+#include <string>
+#include <cmath>
+#include <unordered_map>
 
 namespace photon{
 struct photon_player;
 
-typedef std::pair<uint8_t, uint8_t>  photon_level_coord;
+#define PHOTON_CHUNK_SHIFT 4
+#define PHOTON_CHUNK_SIZE (1 << PHOTON_CHUNK_SHIFT)
+#define PHOTON_CHUNK_MASK (PHOTON_CHUNK_SIZE - 1)
+// 64 bit words needed for one bit per block in a chunk.
+#define PHOTON_CHUNK_WORDS (PHOTON_CHUNK_SIZE * PHOTON_CHUNK_SIZE / 64)
+
+// the largest width or height a level can have, not counting the border.
+#define PHOTON_LEVEL_MAX_SIZE 65536
+
+struct photon_level_chunk{
+    // level coordinates of the chunk's lower left block.
+    glm::uvec2 origin;
+
+    // number of non-air blocks, chunks that reach 0 are freed at the end of the frame.
+    uint16_t block_count = 0;
+
+    // blocks stored row-major (index = y * PHOTON_CHUNK_SIZE + x).
+    photon_block blocks[PHOTON_CHUNK_SIZE * PHOTON_CHUNK_SIZE];
+
+    // one bit per block (same order as blocks) for blocks hit by a beam this frame & last frame.
+    // (see level::SetActivated() & level::WasActivated())
+    uint64_t activated[PHOTON_CHUNK_WORDS] = {};
+    uint64_t was_activated[PHOTON_CHUNK_WORDS] = {};
+
+    // stamped by level::OnBlockChanged() from a counter shared by every level whenever a block is placed,
+    // removed, rotated or moved. anything caching the chunk's contents compares it to tell when it's stale.
+    uint64_t version = 0;
+};
+
+// positions of the non-air blocks on each line through the level, lets the tracer skip over air.
+struct photon_level_occupancy{
+    // x positions keyed by y.
+    std::unordered_map<uint32_t, std::set<uint32_t>> rows;
+    // y positions keyed by x.
+    std::unordered_map<uint32_t, std::set<uint32_t>> columns;
+    // x positions keyed by x - y. (going up and right)
+    std::unordered_map<uint32_t, std::set<uint32_t>> diagonals;
+    // x positions keyed by x + y. (going down and right)
+    std::unordered_map<uint32_t, std::set<uint32_t>> antidiagonals;
+};
+
+// something the player does to the level, queued by input & done at the start of the next tick
+// so it happens on a tick boundary however often frames are drawn. (see level::QueueAction())
+struct photon_level_action{
+    enum action_type : uint8_t{
+        interact,                   // blocks::OnPhotonInteract()
+        rotate,                     // blocks::OnRotate() clockwise.
+        rotate_counter_clockwise,   // blocks::OnRotate() counter-clockwise.
+        rotate_to                   // blocks::OnRotate() to angle.
+    };
+    action_type type;
+    glm::uvec2 location;
+    // in degrees, only for rotate_to.
+    float angle;
+};
 
 struct photon_level{
     enum game_mode{
@@ -21,11 +79,41 @@ struct photon_level{
         script          // uses a script to do the objectives.
     };
 
-    std::map<photon_level_coord, photon_block> grid;
+    // chunks of blocks keyed by chunk coordinates (see level::ChunkKey()), only allocated where there are blocks.
+    std::unordered_map<uint64_t, photon_level_chunk> grid;
+    photon_level_occupancy occupancy;
+
+    // blocks that need blocks::OnFrame() called on them, keyed by level::ActiveKey().
+    std::set<uint64_t> active_blocks;
+    // chunks with bits set in activated & was_activated, so SwapActivation() only touches those. (may have duplicates)
+    std::vector<uint64_t> activated_chunks;
+    std::vector<uint64_t> was_activated_chunks;
+    // power of the active blocks before the last tick as (level::ActiveKey(), power) sorted by key, used to interpolate
+    // drawing between ticks. refilled every tick, kept around so that doesn't allocate. (see level::GetPreviousPower())
+    std::vector<std::pair<uint64_t, float>> previous_power;
+
+    // actions waiting for the next tick.
+    std::vector<photon_level_action> actions;
+
+    // number of blocks of each type, air & invalid blocks are not counted.
+    uint32_t block_counts[block_type_count] = {};
+    // number of plain receivers (the kind powered by light of any color) with at least PHOTON_RECEIVER_POWERED power.
+    // compared with block_counts[receiver] by CheckVictory() for power levels.
+    uint32_t powered_receivers = 0;
     std::vector<photon_laserbeam> beams;
 
-    uint8_t width = 0;
-    uint8_t height = 0;
+    // the beam segments passing through each chunk, keyed by level::ChunkKey().
+    // kept up to date as beams get retraced, used to find beams near a block or point.
+    std::unordered_map<uint64_t, std::vector<photon_segment_ref>> beam_index;
+
+    // if true beams gets rebuilt from the emitters next frame.
+    bool emitters_changed = true;
+    // the beam UpdateBeams() starts looking for dirty beams at, moved past the beams that fit in the trace budget
+    // so the ones after them aren't left waiting for as long as the earlier ones keep getting dirty.
+    uint32_t trace_start = 0;
+
+    uint32_t width = 0;
+    uint32_t height = 0;
 
     // the time spent on the level.
     float time = 0.0f;
@@ -41,26 +129,118 @@ struct photon_level{
     int16_t blocks_destroyed = 0;
     int16_t goal = 0;
 
+    // message shown to the player, set from Lua. cleared when a new level is loaded.
+    std::string message;
+    float message_timeout = INFINITY;
+
     // the lua reference to the victory checking function for script game modes.
     int lua_checkvictory = -2;
 };
 
+// runs a level in fixed length ticks no matter how often frames are drawn. (see level::RunTicks())
+struct photon_timestep{
+    // length of one tick in seconds.
+    float tick = 1.0f / 60.0f;
+    // most ticks run by one call to RunTicks(), any time past that is dropped so a slow frame can't snowball.
+    uint32_t max_ticks = 8;
+
+    // time not simulated yet, less than tick after RunTicks().
+    float accumulator = 0.0f;
+
+    uint64_t ticks = 0;
+    // ticks skipped because of max_ticks.
+    uint64_t dropped_ticks = 0;
+};
+
 namespace level{
 
-void Draw(photon_level &level);
+void ResizeGrid(photon_level &level, uint32_t width, uint32_t height);
+
+// fills the edges of the level with indestructible blocks.
+void FillBorder(photon_level &level);
+
+uint64_t ChunkKey(glm::uvec2 location);
+
+// sorts in the same order as GetSortedChunks(), then by position within the chunk.
+uint64_t ActiveKey(glm::uvec2 location);
 
-void DrawBeams(photon_level &level);
+glm::uvec2 ActiveKeyLocation(uint64_t key);
 
-void DrawBeamsLight(photon_level &level);
+// returns nullptr if location is outside the level or in an empty chunk. (i.e. it is air)
+photon_block *GetBlock(photon_level &level, glm::uvec2 location);
 
-void DrawFX(photon_level &level);
+const photon_block *GetBlock(const photon_level &level, glm::uvec2 location);
 
-bool LoadLevelXML(const std::string &filename, photon_instance &instance);
+// allocates the chunk if needed, returns nullptr if location is outside the level.
+photon_block *SetBlock(photon_level &level, glm::uvec2 location, const photon_block &block);
+
+void ClearBlock(photon_level &level, glm::uvec2 location);
+
+// changes the type of the block at location without touching its other values.
+void SetBlockType(photon_level &level, glm::uvec2 location, block_type type);
+
+// sets the power of the block at location, keeping the powered receiver count up to date.
+void SetBlockPower(photon_level &level, glm::uvec2 location, float power);
+
+// marks the block at location as hit by a beam this frame, returns true if something already hit it this frame.
+bool SetActivated(photon_level &level, glm::uvec2 location);
+
+// true if the block at location was hit by a beam last frame.
+bool WasActivated(const photon_level &level, glm::uvec2 location);
+
+// for blocks that move, keeps the block that moved from one location to another counted as hit last frame.
+void MoveActivation(photon_level &level, glm::uvec2 from, glm::uvec2 to);
+
+// makes this frame's hits last frame's & clears this frame's, called at the start of each frame.
+void SwapActivation(photon_level &level);
+
+// number of blocks of type in the level, 0 for air & invalid blocks.
+uint32_t GetBlockCount(const photon_level &level, block_type type);
+
+// number of non-air blocks in the level.
+uint32_t GetBlockCount(const photon_level &level);
+
+// must be called whenever a block's type or rotation changes, marks beams that go through location for retracing
+// & gives the chunk a new version.
+// (SetBlock() & ClearBlock() call it themselves)
+void OnBlockChanged(photon_level &level, glm::uvec2 location);
+
+// finds the first non-air block going from location in direction (one of the 8 45 degree directions).
+// returns false if there isn't one, in which case found is set to the last location inside the level.
+bool FindNextBlock(const photon_level &level, glm::uvec2 location, glm::ivec2 direction, glm::uvec2 &found);
+
+// frees chunks with no blocks left in them.
+void FreeEmptyChunks(photon_level &level);
+
+// chunks sorted by row, then column. for things that need a stable iteration order.
+std::vector<photon_level_chunk*> GetSortedChunks(photon_level &level);
+
+std::vector<const photon_level_chunk*> GetSortedChunks(const photon_level &level);
+
+const char* GetModeName(photon_level::game_mode mode);
+
+// returns none for unknown names.
+photon_level::game_mode GetModeFromName(const char *name);
+
+bool LoadLevelXML(const std::string &filename, photon_level &level, photon_player &player);
 
 void SaveLevelXML(const std::string &filename, const photon_level &level, const photon_player &player);
 
 void AdvanceFrame(photon_level &level, photon_player &player, float time);
 
+// queues an action to be done at the start of the next tick run by RunTicks().
+void QueueAction(photon_level &level, const photon_level_action &action);
+
+// power of the block at location before the last tick, or current_power if it didn't need frame updates then.
+float GetPreviousPower(const photon_level &level, glm::uvec2 location, float current_power);
+
+// adds frame_time to the timestep & runs AdvanceFrame() once for each whole tick, returns the number of ticks run.
+// queued actions are done before the first tick.
+uint32_t RunTicks(photon_timestep &timestep, photon_level &level, photon_player &player, float frame_time);
+
+// how far drawing is between the last two ticks, from 0 to 1.
+float GetInterpolation(const photon_timestep &timestep);
+
 int8_t CheckVictory(photon_level &level, photon_player &player);
 
 }
@@ -0,0 +1,26 @@
+#ifndef _PHOTON_LOG_H_
+#define _PHOTON_LOG_H_
+
+namespace photon{
+
+/*!
+ * \brief Opens the log file, anything printed before this only goes to stdout.
+ * \param filename the file to write the log to.
+ */
+void OpenLog(const char *filename);
+
+/*!
+ * \brief Closes the log file if it is open.
+ */
+void CloseLog();
+
+/*!
+ * \brief Prints formated string to log.
+ * Prints to both stdout and log file (if open). syntax identical to printf().
+ * \param format
+ */
+void PrintToLog(const char *format,...);
+
+}
+
+#endif
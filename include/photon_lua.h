@@ -4,13 +4,20 @@
 #include <string>
 #include <cstdint>
 
+struct luaL_Reg;
+
 namespace photon{
 
-struct photon_instance;
+struct photon_level;
+struct photon_player;
 
 namespace lua{
 
-void InitLua(const std::string &initscript);
+// creates the Lua state & the photon table, the API functions act on the given level & player.
+void InitLua(photon_level &level, photon_player &player);
+
+// adds a table of functions to the photon table, for frontend specific functions. (i.e. photon.window)
+void RegisterAPI(const char *name, const luaL_Reg *funcs);
 
 void AdvanceFrame();
 
@@ -8,6 +8,8 @@
 #include <GL/glcorearb.h>
 #endif
 
+#include "photon_level.h"
+
 #include <glm/glm.hpp>
 #include <vector>
 #include <string>
@@ -21,7 +23,31 @@ struct photon_shader{
 
     std::vector<GLuint> shader_objects;
 
-    GLuint program;
+    GLuint program = 0;
+
+    // uniform locations, looked up once by LoadShaderXML(). -1 if the shader doesn't use it.
+    GLint uniform_view = -1;
+    GLint uniform_view_gui = -1;
+    GLint uniform_center = -1;
+    GLint uniform_model = -1;
+    GLint uniform_color = -1;
+    GLint uniform_fac = -1;
+
+    // the values last uploaded to each uniform, setting one to the value it already has does nothing.
+    // (NAN so the first upload always happens)
+    glm::vec2 center = glm::vec2(NAN);
+    glm::mat3 model = glm::mat3(NAN);
+    glm::vec4 color = glm::vec4(NAN);
+    float fac = NAN;
+
+    // the camera version the view uniforms were last uploaded for, see UseShader().
+    uint32_t camera_version = 0;
+};
+
+// block quads kept in a vertex buffer so they can be drawn again without being rebuilt. (see blocks::BuildMesh())
+struct photon_block_mesh{
+    GLuint vertex_buffer = 0;
+    uint32_t quads = 0;
 };
 
 /*!
@@ -31,6 +57,8 @@ namespace opengl{
 
 #define PHOTON_VERTEX_LOCATION_ATTRIBUTE       0
 #define PHOTON_VERTEX_UV_ATTRIBUTE             1
+// per vertex multiplier for the fx shader's fac, 1 when not coming from a buffer.
+#define PHOTON_VERTEX_FAC_ATTRIBUTE            2
 
 /*!
  * \brief InitOpenGL
@@ -96,6 +124,12 @@ void UpdateZoom(const float &zoom);
  */
 void UpdateCenter(const glm::vec2 &center);
 
+/*!
+ * \brief The part of the level that is on screen.
+ * \return left, bottom, right & top in level coordinates.
+ */
+glm::vec4 GetViewBounds();
+
 /*!
  * \brief switches to the background drawing mode. (clears scene buffer)
  * \param window
@@ -144,6 +178,66 @@ void SetFacFX(const float &fac);
 
 void DrawBackground(photon_instance &instance);
 
+void DrawLaser(photon_laserbeam &beam);
+void DrawLaserSegment(photon_laserbeam &beam, photon_lasersegment &segment);
+
+void DrawLaserLight(photon_laserbeam &beam);
+void DrawLaserSegmentLight(photon_lasersegment &segment);
+
+}
+
+namespace blocks{
+
+void Draw(photon_block block, glm::vec2 location);
+
+void DrawFX(photon_block block, glm::vec2 location);
+
+// adds the block to the blocks drawn by DrawQueued().
+void QueueDraw(photon_block block, glm::vec2 location);
+
+void QueueDrawFX(photon_block block, glm::vec2 location);
+
+// draws all the queued blocks with the current shader in one draw call.
+void DrawQueued();
+
+// moves the queued blocks into mesh instead of drawing them.
+void BuildMesh(photon_block_mesh &mesh);
+
+void DrawMesh(const photon_block_mesh &mesh);
+
+void DeleteMesh(photon_block_mesh &mesh);
+
+// false for blocks that look different depending on more than their type, rotation & location,
+// which can't be kept in a photon_block_mesh.
+bool DrawsStatic(block_type type);
+
+void LoadTextures();
+
+// deletes the buffers used by DrawQueued().
+void GarbageCollect();
+
+// the block texture atlas for the gui's item icon, or 0 for blocks without one.
+GLuint GetBlockTexture(block_type type);
+
+// where the block's image is in the texture from GetBlockTexture(): left, top, right, bottom.
+glm::vec4 GetBlockUV(block_type type);
+
+}
+
+namespace level{
+
+// interpolation is how far between the previous tick & the current one to draw blocks. (see level::GetInterpolation())
+void Draw(photon_level &level, float interpolation = 1.0f);
+
+void DrawBeams(photon_level &level);
+
+void DrawBeamsLight(photon_level &level);
+
+void DrawFX(photon_level &level, float interpolation = 1.0f);
+
+// deletes the cached region meshes used by Draw() & DrawFX().
+void GarbageCollect();
+
 }
 }
 #endif
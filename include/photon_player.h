@@ -5,9 +5,12 @@
 #include "photon_blocks.h"
 
 #include <map>
+#include <cstdint>
 
 namespace photon{
 
+struct photon_level;
+
 struct photon_player{
     glm::vec2 location = glm::vec2(0.0f);
 
@@ -15,12 +18,20 @@ struct photon_player{
     block_type current_item = invalid_block;
 
     bool snap_to_beam = true;
+    // beams further than this from the player aren't snapped to by SnapToBeams(level, player).
+    float snap_distance = 32.0f;
+
+    // the segment the player was last snapped to, checked first next time.
+    photon_segment_ref last_snap = {UINT32_MAX, UINT32_MAX};
 };
 
 namespace player{
 
 glm::vec2 SnapToBeam(photon_laserbeam &beam, glm::vec2 location);
 glm::vec2 SnapToBeams(std::vector<photon_laserbeam> &beams, glm::vec2 location);
+// same result as above for beams within player.snap_distance (otherwise the location doesn't change),
+// but only looks at segments in chunks near the player using level.beam_index.
+glm::vec2 SnapToBeams(const photon_level &level, photon_player &player);
 
 int8_t AddItem(photon_player &player, block_type type, int8_t amount = 1);
 int8_t AddItemCurrent(photon_player &player, int8_t amount = 1);
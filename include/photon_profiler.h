@@ -0,0 +1,77 @@
+#ifndef _PHOTON_PROFILER_H_
+#define _PHOTON_PROFILER_H_
+
+#include <atomic>
+#include <string>
+#include <cstdint>
+
+namespace photon{
+
+namespace profiler{
+
+extern std::atomic<bool> enabled;
+
+/*!
+ * \brief nanoseconds since the profiler started.
+ */
+int64_t Now();
+
+/*!
+ * \brief adds a zone to the calling thread's ring buffer, the oldest zones get overwritten once it is full.
+ * \param name must outlive the profiler (i.e. a string literal), only the pointer is stored.
+ */
+void Record(const char *name, int64_t start, int64_t end);
+
+/*!
+ * \brief turns recording on or off, it is on by default.
+ */
+void SetEnabled(bool enable);
+
+/*!
+ * \brief names the calling thread in the trace output.
+ */
+void SetThreadName(const char *name);
+
+/*!
+ * \brief Writes every recorded zone in the Chrome trace_event format. (load it in chrome://tracing)
+ * Only call this while the other threads aren't recording, i.e. between frames.
+ * \param filename path in the PhysFS write directory.
+ * \return false if the file couldn't be written.
+ */
+bool WriteChromeTrace(const std::string &filename);
+
+}
+
+/*!
+ * \brief records the time from creation to destruction, use PHOTON_PROFILE_ZONE() instead of using this directly.
+ */
+struct photon_profiler_zone{
+    const char *name;
+    int64_t start = -1;
+
+    explicit photon_profiler_zone(const char *zone_name) : name(zone_name){
+        if(profiler::enabled.load(std::memory_order_relaxed)){
+            start = profiler::Now();
+        }
+    }
+
+    ~photon_profiler_zone(){
+        if(start >= 0){
+            profiler::Record(name, start, profiler::Now());
+        }
+    }
+};
+
+#define PHOTON_PROFILE_CONCAT_INNER(a, b) a##b
+#define PHOTON_PROFILE_CONCAT(a, b) PHOTON_PROFILE_CONCAT_INNER(a, b)
+
+#ifdef PHOTON_WITH_PROFILER
+// profiles the rest of the enclosing scope.
+#define PHOTON_PROFILE_ZONE(name) photon::photon_profiler_zone PHOTON_PROFILE_CONCAT(photon_profile_zone_, __LINE__)(name)
+#else
+#define PHOTON_PROFILE_ZONE(name)
+#endif
+
+}
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef _PHOTON_SIM_H_
+#define _PHOTON_SIM_H_
+
+// everything needed to run a level without a window, used by the game & the headless tools.
+
+#include "photon_log.h"
+#include "photon_level.h"
+#include "photon_player.h"
+#include "photon_lua.h"
+#include "photon_generator.h"
+#include "photon_profiler.h"
+#include "photon_stats.h"
+
+namespace photon{
+
+/*!
+ * \brief holds version information.
+ */
+namespace build_info{
+/*!
+ * \brief holds the builds git sha1 value.
+ */
+extern const char* git_sha1;
+
+/*!
+ * \brief holds the build type (as defined in CMake by CMAKE_BUILD_TYPE)
+ */
+extern const char* build_type;
+
+/*!
+ * \brief version
+ */
+extern const char* version;
+}
+
+}
+
+#endif
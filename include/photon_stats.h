@@ -0,0 +1,51 @@
+#ifndef _PHOTON_STATS_H_
+#define _PHOTON_STATS_H_
+
+#include <cstdint>
+
+namespace photon{
+
+#define PHOTON_HISTOGRAM_SUB_BITS 4
+#define PHOTON_HISTOGRAM_SUB_BUCKETS (1 << PHOTON_HISTOGRAM_SUB_BITS)
+// enough buckets for values up to 2^32 (over an hour in microseconds), larger values go in the last bucket.
+#define PHOTON_HISTOGRAM_BUCKETS ((32 - PHOTON_HISTOGRAM_SUB_BITS + 1) * PHOTON_HISTOGRAM_SUB_BUCKETS)
+
+// fixed size histogram with log-linear buckets, exact below PHOTON_HISTOGRAM_SUB_BUCKETS,
+// then every power of 2 is split into PHOTON_HISTOGRAM_SUB_BUCKETS. (within about 6%)
+struct photon_histogram{
+    uint32_t counts[PHOTON_HISTOGRAM_BUCKETS] = {};
+
+    uint64_t count = 0;
+    uint64_t max = 0;
+
+    // values above budget are counted in over_budget, 0 for no budget.
+    uint64_t budget = 0;
+    uint64_t over_budget = 0;
+};
+
+// all times are in microseconds.
+struct photon_frame_stats{
+    // time spent on each frame, not counting waiting for the buffer swap.
+    photon_histogram frame_time;
+    // time spent running ticks each frame.
+    photon_histogram sim_time;
+};
+
+namespace stats{
+
+void Record(photon_histogram &histogram, uint64_t value);
+
+// the value below which percentile percent of the values are, rounded up to the end of its bucket.
+uint64_t GetPercentile(const photon_histogram &histogram, double percentile);
+
+// clears everything except the budget.
+void Reset(photon_histogram &histogram);
+
+// prints p50, p90, p99, max & the count over budget.
+void PrintReport(const char *name, const photon_histogram &histogram);
+
+}
+
+}
+
+#endif
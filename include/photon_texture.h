@@ -13,6 +13,13 @@ namespace texture{
 #define PHOTON_TEXTURE_UNIT_COLOR          GL_TEXTURE0
 #define PHOTON_TEXTURE_UNIT_LIGHT          GL_TEXTURE1
 
+// width atlases start at, they get taller (or wider for big images) as needed.
+#define PHOTON_ATLAS_WIDTH                 1024
+// transparent pixels around each image in an atlas.
+#define PHOTON_ATLAS_PADDING               16
+// the last mipmap level that keeps images in an atlas apart. (log2 of PHOTON_ATLAS_PADDING)
+#define PHOTON_ATLAS_MAX_LEVEL             4
+
 /*!
  * \brief Loads texture from file.
  * \param filename Filename for the texture.
@@ -20,6 +27,14 @@ namespace texture{
  */
 GLuint Load(const std::string &filename);
 
+/*!
+ * \brief Packs images into one texture, so things using different images can be drawn without switching textures.
+ * \param filenames Filenames of the images.
+ * \param rects Set to the uv rectangle (left, top, right, bottom) of each image, all 0 if it failed to load.
+ * \return the texture.
+ */
+GLuint LoadAtlas(const std::vector<std::string> &filenames, std::vector<glm::vec4> &rects);
+
 /*!
  * \brief GarbageCollect
  */
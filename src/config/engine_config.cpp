@@ -147,6 +147,46 @@ bool LoadEngineConfig(const std::string &filename, photon_instance &instance){
         xmlFree(multisample_str);
     }
 
+    xmlChar *trace_threads_str = xmlGetProp(root, (const xmlChar*)"trace_threads");
+
+    if(trace_threads_str != nullptr){
+        instance.settings.trace_threads = atoi((char*)trace_threads_str);
+
+        xmlFree(trace_threads_str);
+    }
+
+    xmlChar *trace_budget_str = xmlGetProp(root, (const xmlChar*)"trace_budget");
+
+    if(trace_budget_str != nullptr){
+        instance.settings.trace_budget = strtoul((char*)trace_budget_str, nullptr, 10);
+
+        xmlFree(trace_budget_str);
+    }
+
+    xmlChar *tick_rate_str = xmlGetProp(root, (const xmlChar*)"tick_rate");
+
+    if(tick_rate_str != nullptr){
+        instance.settings.tick_rate = atof((char*)tick_rate_str);
+
+        xmlFree(tick_rate_str);
+    }
+
+    xmlChar *max_ticks_str = xmlGetProp(root, (const xmlChar*)"max_ticks");
+
+    if(max_ticks_str != nullptr){
+        instance.settings.max_ticks = atoi((char*)max_ticks_str);
+
+        xmlFree(max_ticks_str);
+    }
+
+    xmlChar *frame_budget_str = xmlGetProp(root, (const xmlChar*)"frame_budget");
+
+    if(frame_budget_str != nullptr){
+        instance.settings.frame_budget = atof((char*)frame_budget_str);
+
+        xmlFree(frame_budget_str);
+    }
+
     xmlFreeDoc(doc);
 
     return true;
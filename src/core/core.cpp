@@ -2,18 +2,73 @@
 #include "photon_lua.h"
 
 #include <stdlib.h>
-#include <ctime>
-#include <cstdio>
-#include <stdarg.h>
 #include <physfs.h>
+#include <lua.hpp>
 
 namespace photon{
-FILE* logfile;
-
 photon_instance instance;
 
+namespace window_funcs{
+
+static int ToggleFullscreen(lua_State *L) {
+    window_managment::ToggleFullscreen(instance.window);
+    return 0;
+}
+
+static const luaL_Reg funcs[] = {
+    {"toggle_fullscreen", ToggleFullscreen},
+    {nullptr, nullptr}
+};
+
+}
+
+namespace stats_funcs{
+
+// pushes a table of the histogram's percentiles in milliseconds.
+static void PushHistogram(lua_State *L, const photon_histogram &histogram){
+    lua_createtable(L, 0, 6);
+    lua_pushnumber(L, stats::GetPercentile(histogram, 50.0) * 1.0e-3);
+    lua_setfield(L, -2, "p50");
+    lua_pushnumber(L, stats::GetPercentile(histogram, 90.0) * 1.0e-3);
+    lua_setfield(L, -2, "p90");
+    lua_pushnumber(L, stats::GetPercentile(histogram, 99.0) * 1.0e-3);
+    lua_setfield(L, -2, "p99");
+    lua_pushnumber(L, histogram.max * 1.0e-3);
+    lua_setfield(L, -2, "max");
+    lua_pushinteger(L, histogram.count);
+    lua_setfield(L, -2, "count");
+    lua_pushinteger(L, histogram.over_budget);
+    lua_setfield(L, -2, "over_budget");
+}
+
+static int FrameTime(lua_State *L) {
+    PushHistogram(L, instance.stats.frame_time);
+    return 1;
+}
+
+static int SimTime(lua_State *L) {
+    PushHistogram(L, instance.stats.sim_time);
+    return 1;
+}
+
+static int Reset(lua_State *L) {
+    stats::Reset(instance.stats.frame_time);
+    stats::Reset(instance.stats.sim_time);
+    return 0;
+}
+
+static const luaL_Reg funcs[] = {
+    {"frame_time", FrameTime},
+    {"sim_time", SimTime},
+    {"reset", Reset},
+    {nullptr, nullptr}
+};
+
+}
+
 photon_instance &Init(int argc, char *argv[]){
-    logfile = fopen("photon.log", "w");
+    OpenLog("photon.log");
+    profiler::SetThreadName("main");
     PrintToLog("INFO: Starting up Photon. Executable: \"%s\"", argv[0]);
 
     PrintToLog("INFO: Photon %s, git sha1: %s", build_info::version, build_info::git_sha1);
@@ -22,6 +77,20 @@ photon_instance &Init(int argc, char *argv[]){
 
     LoadEngineConfig("photon.xml", instance);
 
+    tracer::InitThreads(instance.settings.trace_threads);
+    tracer::SetTraceBudget(instance.settings.trace_budget);
+
+    if(instance.settings.tick_rate > 0.0f){
+        instance.timestep.tick = 1.0f / instance.settings.tick_rate;
+    }else{
+        PrintToLog("WARNING: invalid tick rate %f, using %f.", instance.settings.tick_rate, 1.0f / instance.timestep.tick);
+    }
+    instance.timestep.max_ticks = std::max(instance.settings.max_ticks, 1);
+
+    instance.stats.frame_time.budget = std::max(instance.settings.frame_budget, 0.0f) * 1.0e3f;
+    // if a tick takes longer than the time it simulates the level can't keep up.
+    instance.stats.sim_time.budget = instance.timestep.tick * 1.0e6f;
+
     PHYSFS_init(argv[0]);
     if(!SetRootPhysFS(instance.settings.data_path.c_str(), true)){
         SetRootPhysFS("data", true);
@@ -45,7 +114,10 @@ photon_instance &Init(int argc, char *argv[]){
         input::LoadConfig(instance.settings.input_config, instance.input);
     }
 
-    lua::InitLua("/init.lua");
+    lua::InitLua(instance.level, instance.player);
+    lua::RegisterAPI("window", window_funcs::funcs);
+    lua::RegisterAPI("stats", stats_funcs::funcs);
+    lua::DoFile("/init.lua");
 
     return instance;
 }
@@ -54,66 +126,19 @@ void GarbageCollect(photon_instance &instance){
     PrintToLog("INFO: Doing garbage collection.");
     input::GarbageCollect(instance.input);
 
+    tracer::GarbageCollect();
+
     opengl::GarbageCollect(instance.window);
     window_managment::GarbageCollect(instance.window);
 
     PHYSFS_deinit();
 
     PrintToLog("INFO: Photon garbage collection complete (except log file, doing that now...)");
-    fclose(logfile);
+    CloseLog();
 }
 
 void Close(photon_instance &instance){
     PrintToLog("INFO: Request to shutdown Photon recieved.");
     instance.running = false;
 }
-
-#ifdef _MSC_VER
-#define snprintf _snprintf
-#endif
-
-void PrintToLog(const char *format,...){
-    va_list args, args2;
-    va_start(args, format);
-    va_copy(args2, args);
-
-    /* Create the timestamp string */
-    std::chrono::high_resolution_clock::time_point current = std::chrono::high_resolution_clock::now();
-
-    time_t tnow = std::chrono::high_resolution_clock::to_time_t(current);
-    tm *date = std::localtime(&tnow);
-    int microseconds = std::chrono::duration_cast<std::chrono::microseconds>(current.time_since_epoch()).count() % 1000000;
-
-    /* The size of this is constant, so it might as well not be on the heap.
-     * It saves us from some confusing sizing & position calculation by keeping it seperate from the main output string. */
-    char timestamp[18];
-    snprintf(timestamp, 18, "%02i:%02i:%02i.%06i: ", date->tm_hour, date->tm_min, date->tm_sec, microseconds);
-    timestamp[17] = '\0';
-
-    /* Create the main output string */
-    int len = vsnprintf(nullptr, 0, format, args) + 1;
-
-    char* buffer = new char[len + 1];
-
-    vsnprintf(buffer, len, format, args2);
-
-    va_end(args);
-    va_end(args2);
-
-    buffer[len - 1] = '\n';
-    buffer[len] = '\0';
-
-    /* Write the strings to stdout and log file. */
-    fprintf(stdout, timestamp);
-    fprintf(stdout, buffer);
-    fflush(stdout);
-
-    if(logfile){
-        fprintf(logfile, timestamp);
-        fprintf(logfile, buffer);
-        fflush(logfile);
-    }
-
-    delete[] buffer;
-}
 }
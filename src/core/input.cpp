@@ -186,7 +186,7 @@ void DoInput(photon_instance &instance, float time){
                 if(buttons & SDL_BUTTON_RMASK){
                     float angle = glm::degrees(glm::atan(delta.y, delta.x));
 
-                    blocks::OnRotate(glm::uvec2(instance.player.location + 0.5f), instance.level, angle);
+                    level::QueueAction(instance.level, {photon_level_action::rotate_to, glm::uvec2(instance.player.location + 0.5f), angle});
                 }
             }
         }
@@ -198,14 +198,16 @@ void DoInput(photon_instance &instance, float time){
         instance.camera_offset.x /= 1.0f + (time * 2.0f);
         instance.camera_offset.y /= 1.0f + (time * 2.0f);
 
+        // changes to the level wait for the next tick.
+        glm::uvec2 block_location(instance.player.location + glm::vec2(0.5f));
         if(IsActivated(input.interact)){
-            blocks::OnPhotonInteract(glm::uvec2(instance.player.location + glm::vec2(0.5f)), instance.level, instance.player);
+            level::QueueAction(instance.level, {photon_level_action::interact, block_location});
         }
         if(IsActivated(input.rotate_clockwise)){
-            blocks::OnRotate(glm::uvec2(instance.player.location + glm::vec2(0.5f)), instance.level);
+            level::QueueAction(instance.level, {photon_level_action::rotate, block_location});
         }
         if(IsActivated(input.rotate_counter_clockwise)){
-            blocks::OnRotate(glm::uvec2(instance.player.location + glm::vec2(0.5f)), instance.level, true);
+            level::QueueAction(instance.level, {photon_level_action::rotate_counter_clockwise, block_location});
         }
         if(IsActivated(input.next_item)){
             player::NextItem(instance.player);
@@ -256,6 +258,11 @@ void DoEvents(photon_instance &instance){
             }
             if(event.key.keysym.sym == SDLK_f && event.key.keysym.mod & KMOD_CTRL){
                 window_managment::ToggleFullscreen(instance.window);
+            }else if(event.key.keysym.sym == SDLK_p && event.key.keysym.mod & KMOD_CTRL){
+                profiler::WriteChromeTrace("photon_trace.json");
+            }else if(event.key.keysym.sym == SDLK_h && event.key.keysym.mod & KMOD_CTRL){
+                stats::PrintReport("Frame Time", instance.stats.frame_time);
+                stats::PrintReport("Sim Time", instance.stats.sim_time);
             }else if(event.key.keysym.sym == SDLK_i && event.key.keysym.mod & KMOD_CTRL){
                 // re-detect input. by doing a garbage collect and an init over again it will detect newly connected controllers.
                 PrintToLog("INFO: Reinitilizing input system to redetect available devices...");
@@ -339,7 +346,7 @@ void DoEvents(photon_instance &instance){
             }else if(event.button.button == SDL_BUTTON_LEFT){
                 if(!gui::HandleMouseClick(instance, event.button.x, event.button.y)){
                     if(glm::length(instance.player.location - WindowToWorldCoord(instance, event.button.x, event.button.y)) < 0.5f){
-                        blocks::OnPhotonInteract(glm::uvec2(instance.player.location + 0.5f), instance.level, instance.player);
+                        level::QueueAction(instance.level, {photon_level_action::interact, glm::uvec2(instance.player.location + 0.5f)});
                     }
                 }
             }
@@ -13,54 +13,77 @@ void MainLoop(photon_instance &instance){
     PrintToLog("INFO: Main loop started at: %f seconds.", (start_time - instance.creation_time));
 
     while(instance.running){
+        PHOTON_PROFILE_ZONE("frame");
         std::chrono::high_resolution_clock::time_point current = std::chrono::high_resolution_clock::now();
         frame_delta = std::chrono::duration_cast<std::chrono::microseconds>(current - last_time).count() * 1.0e-6f;
         last_time = current;
 
-        input::DoEvents(instance);
+        {
+            PHOTON_PROFILE_ZONE("input");
+            input::DoEvents(instance);
 
-        input::DoInput(instance, frame_delta);
+            input::DoInput(instance, frame_delta);
+        }
 
         instance.camera_offset.z = std::max(0.01f, instance.camera_offset.z);
         opengl::UpdateZoom(instance.camera_offset.z);
 
         if(instance.level.is_valid){
             if(!instance.paused){
-                level::AdvanceFrame(instance.level, instance.player, frame_delta);
+                PHOTON_PROFILE_ZONE("level::RunTicks");
+                std::chrono::high_resolution_clock::time_point sim_start = std::chrono::high_resolution_clock::now();
+
+                level::RunTicks(instance.timestep, instance.level, instance.player, frame_delta);
+
+                stats::Record(instance.stats.sim_time, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - sim_start).count());
             }
+            float interpolation = level::GetInterpolation(instance.timestep);
 
             if(instance.player.snap_to_beam){
-                instance.player.location = player::SnapToBeams(instance.level.beams, instance.player.location);
+                PHOTON_PROFILE_ZONE("player::SnapToBeams");
+                instance.player.location = player::SnapToBeams(instance.level, instance.player);
             }
 
             opengl::UpdateCenter(instance.player.location + glm::vec2(instance.camera_offset));
 
-            opengl::DrawModeLight(instance.window);
-
-            level::DrawBeamsLight(instance.level);
-
-            opengl::SetLaserColor(glm::vec3(1.0f));
+            {
+                PHOTON_PROFILE_ZONE("opengl::DrawModeLight");
+                opengl::DrawModeLight(instance.window);
 
-            opengl::DrawPhotonLight(instance.player.location);
-
-            opengl::DrawModeScene(instance.window);
-
-            opengl::DrawBackground(instance);
+                level::DrawBeamsLight(instance.level);
 
-            opengl::DrawModeLaser(instance.window);
+                opengl::SetLaserColor(glm::vec3(1.0f));
 
-            level::DrawBeams(instance.level);
+                opengl::DrawPhotonLight(instance.player.location);
+            }
+            {
+                PHOTON_PROFILE_ZONE("opengl::DrawModeScene");
+                opengl::DrawModeScene(instance.window);
 
-            opengl::DrawModeLevel(instance.window);
+                opengl::DrawBackground(instance);
+            }
+            {
+                PHOTON_PROFILE_ZONE("opengl::DrawModeLaser");
+                opengl::DrawModeLaser(instance.window);
 
-            level::Draw(instance.level);
+                level::DrawBeams(instance.level);
+            }
+            {
+                PHOTON_PROFILE_ZONE("opengl::DrawModeLevel");
+                opengl::DrawModeLevel(instance.window);
 
-            opengl::DrawModeFX(instance.window);
+                level::Draw(instance.level, interpolation);
+            }
+            {
+                PHOTON_PROFILE_ZONE("opengl::DrawModeFX");
+                opengl::DrawModeFX(instance.window);
 
-            opengl::DrawPhoton(instance.player.location);
+                opengl::DrawPhoton(instance.player.location);
 
-            level::DrawFX(instance.level);
+                level::DrawFX(instance.level, interpolation);
+            }
         }else{
+            PHOTON_PROFILE_ZONE("opengl::DrawModeScene");
             // this is so that the screen gets cleared.
             opengl::DrawModeScene(instance.window);
 
@@ -68,11 +91,19 @@ void MainLoop(photon_instance &instance){
             opengl::DrawBackground(instance);
         }
 
-        opengl::DrawModeGUI(instance.window);
+        {
+            PHOTON_PROFILE_ZONE("opengl::DrawModeGUI");
+            opengl::DrawModeGUI(instance.window);
 
-        gui::DrawGUI(instance);
+            gui::DrawGUI(instance);
+        }
+        // the buffer swap can wait for vsync, so it isn't counted.
+        stats::Record(instance.stats.frame_time, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - current).count());
 
-        window_managment::UpdateWindow(instance.window);
+        {
+            PHOTON_PROFILE_ZONE("SwapWindow");
+            window_managment::UpdateWindow(instance.window);
+        }
 
         instance.total_frames++;
     }
@@ -87,6 +118,9 @@ void MainLoop(photon_instance &instance){
     PrintToLog("INFO: Average Draw Time: %fms.", (std::chrono::duration_cast<std::chrono::microseconds>(current - start_time).count() * 1.0e-3f) / float(instance.total_frames));
     // print average framerate by inverting the total draw time.
     PrintToLog("INFO: Average Framerate: %f fps.", (1.0f / (std::chrono::duration_cast<std::chrono::microseconds>(current - start_time).count() / float(instance.total_frames))) * 1.0e6f);
+
+    stats::PrintReport("Frame Time", instance.stats.frame_time);
+    stats::PrintReport("Sim Time", instance.stats.sim_time);
 }
 
 }
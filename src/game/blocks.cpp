@@ -1,4 +1,4 @@
-#include "photon_core.h"
+#include "photon_sim.h"
 
 #include <glm/gtx/norm.hpp>
 
@@ -6,228 +6,235 @@ namespace photon{
 
 namespace blocks{
 
-photon_lasersegment *OnLightInteract(photon_lasersegment *segment, glm::uvec2 location, photon_level &level, float time){
-    photon_level_coord coord(location.x, location.y);
-    if(level.grid.count(coord)){
-        photon_block &block = level.grid[coord];
+#define R PHOTON_COLOR_RED
+#define G PHOTON_COLOR_GREEN
+#define B PHOTON_COLOR_BLUE
+#define W PHOTON_COLOR_WHITE
 
-        bool wasactivated = block.activated;
-        block.activated = true;
+extern constexpr photon_block_traits block_traits[block_type_count] = {
+//   type            name              texture                         fx texture                       scale  rotation rotatable pickable destructible stops  hits   frame  color
+    {air,            "air",            block_texture_none,             block_texture_none,              0.5f,  false,   false,    false,   false,       false, false, false, 0},
+    {mirror,         "mirror",         block_texture_mirror,           block_texture_none,              0.4f,  true,    true,     true,    false,       false, false, false, 0},
+    {mirror_locked,  "mirror_locked",  block_texture_mirror,           block_texture_none,              0.4f,  true,    false,    false,   false,       false, false, false, 0},
+    {plain,          "plain",          block_texture_plain,            block_texture_none,              0.5f,  false,   false,    false,   true,        true,  false, false, 0},
+    {indestructible, "indestructible", block_texture_indestructible,   block_texture_none,              0.5f,  false,   false,    false,   false,       true,  false, false, 0},
+    {emitter_white,  "emitter_white",  block_texture_emitter,          block_texture_none,              0.5f,  true,    false,    false,   false,       true,  false, false, W},
+    {emitter_red,    "emitter_red",    block_texture_emitter,          block_texture_none,              0.5f,  true,    false,    false,   false,       true,  false, false, R},
+    {emitter_green,  "emitter_green",  block_texture_emitter,          block_texture_none,              0.5f,  true,    false,    false,   false,       true,  false, false, G},
+    {emitter_blue,   "emitter_blue",   block_texture_emitter,          block_texture_none,              0.5f,  true,    false,    false,   false,       true,  false, false, B},
+    // plain receivers take any color.
+    {receiver,       "receiver",       block_texture_receiver,         block_texture_receiver_fx,       0.5f,  true,    false,    false,   false,       true,  true,  true,  0},
+    {receiver_white, "receiver_white", block_texture_receiver,         block_texture_receiver_fx,       0.5f,  true,    false,    false,   false,       true,  true,  true,  W},
+    {receiver_red,   "receiver_red",   block_texture_receiver,         block_texture_receiver_fx_red,   0.5f,  true,    false,    false,   false,       true,  true,  true,  R},
+    {receiver_green, "receiver_green", block_texture_receiver,         block_texture_receiver_fx_green, 0.5f,  true,    false,    false,   false,       true,  true,  true,  G},
+    {receiver_blue,  "receiver_blue",  block_texture_receiver,         block_texture_receiver_fx_blue,  0.5f,  true,    false,    false,   false,       true,  true,  true,  B},
+    {target,         "target",         block_texture_target,           block_texture_none,              0.5f,  false,   false,    false,   true,        true,  false, false, 0},
+    {tnt,            "tnt",            block_texture_tnt,              block_texture_filter_red,        0.5f,  false,   false,    true,    false,       true,  true,  true,  0},
+    {tnt_fireball,   "tnt_fireball",   block_texture_none,             block_texture_explosion,         1.5f,  false,   false,    false,   false,       false, false, true,  0},
+    {filter_red,     "filter_red",     block_texture_filter_red,       block_texture_none,              0.2f,  false,   false,    true,    false,       false, false, false, R},
+    {filter_green,   "filter_green",   block_texture_filter_green,     block_texture_none,              0.2f,  false,   false,    true,    false,       false, false, false, G},
+    {filter_blue,    "filter_blue",    block_texture_filter_blue,      block_texture_none,              0.2f,  false,   false,    true,    false,       false, false, false, B},
+    {filter_yellow,  "filter_yellow",  block_texture_filter_yellow,    block_texture_none,              0.2f,  false,   false,    true,    false,       false, false, false, R | G},
+    {filter_cyan,    "filter_cyan",    block_texture_filter_cyan,      block_texture_none,              0.2f,  false,   false,    true,    false,       false, false, false, G | B},
+    {filter_magenta, "filter_magenta", block_texture_filter_magenta,   block_texture_none,              0.2f,  false,   false,    true,    false,       false, false, false, R | B},
+    // TODO - make texture.
+    {move,           "move",           block_texture_indestructible,   block_texture_none,              0.5f,  true,    false,    false,   false,       false, true,  true,  0},
+    {move_reverse,   "move_reverse",   block_texture_indestructible,   block_texture_none,              0.5f,  true,    false,    false,   false,       false, true,  true,  0},
+};
 
-        switch(block.type){
-        case air:
-        default:
-            break;
-        case receiver:
-            block.power++;
-            // stops tracing the laser.
-            return nullptr;
-            break;
-        case receiver_red:
-            if(segment->color.r > 0.8f){
-                block.power++;
-            }
-            // stops tracing the laser.
-            return nullptr;
-            break;
-        case receiver_green:
-            if(segment->color.g > 0.8f){
-                block.power++;
-            }
-            // stops tracing the laser.
-            return nullptr;
-            break;
-        case receiver_blue:
-            if(segment->color.b > 0.8f){
-                block.power++;
-            }
-            // stops tracing the laser.
-            return nullptr;
-            break;
-        case receiver_white:
-            if(segment->color.r > 0.8f && segment->color.g > 0.8f && segment->color.b > 0.8f){
-                block.power++;
-            }
-            // stops tracing the laser.
-            return nullptr;
-            break;
-        case tnt:
-            block.power += time;
-        case emitter_white:
-        case emitter_red:
-        case emitter_green:
-        case emitter_blue:
-        case plain:
-        case indestructible:
-        case target:
+#undef R
+#undef G
+#undef B
+#undef W
+
+constexpr bool TraitsInOrder(uint32_t i = 0){
+    return i == block_type_count || (block_traits[i].type == block_type(i) && block_traits[i].name != nullptr && TraitsInOrder(i + 1));
+}
+static_assert(TraitsInOrder(), "block_traits needs an entry for every block_type, in order.");
+
+// outgoing beam direction for each incoming direction & mirror rotation, mirror_blocked if the beam hits the mirror edge on.
+// (reflecting off a mirror at rotation r sends a beam going in direction d to r - d)
+static const uint8_t mirror_blocked = 0xff;
+static constexpr uint8_t mirror_reflections[PHOTON_DIRECTIONS][PHOTON_ROTATION_STEPS] = {
+    {mirror_blocked, 1, 2, 3, 4, 5, 6, 7, mirror_blocked, 1, 2, 3, 4, 5, 6, 7},
+    {7, 0, mirror_blocked, 2, 3, 4, 5, 6, 7, 0, mirror_blocked, 2, 3, 4, 5, 6},
+    {6, 7, 0, 1, mirror_blocked, 3, 4, 5, 6, 7, 0, 1, mirror_blocked, 3, 4, 5},
+    {5, 6, 7, 0, 1, 2, mirror_blocked, 4, 5, 6, 7, 0, 1, 2, mirror_blocked, 4},
+    {mirror_blocked, 5, 6, 7, 0, 1, 2, 3, mirror_blocked, 5, 6, 7, 0, 1, 2, 3},
+    {3, 4, mirror_blocked, 6, 7, 0, 1, 2, 3, 4, mirror_blocked, 6, 7, 0, 1, 2},
+    {2, 3, 4, 5, mirror_blocked, 7, 0, 1, 2, 3, 4, 5, mirror_blocked, 7, 0, 1},
+    {1, 2, 3, 4, 5, 6, mirror_blocked, 0, 1, 2, 3, 4, 5, 6, mirror_blocked, 0}
+};
+
+// records a hit for blocks that react to the beam, see OnLightHit().
+void AddHit(photon_laserbeam &beam, photon_lasersegment *segment, glm::uvec2 location){
+    photon_laserhit hit;
+    hit.location = location;
+    hit.direction = segment->direction;
+    hit.color = segment->color;
+    beam.hits.push_back(hit);
+}
+
+photon_lasersegment *OnLightInteract(photon_laserbeam &beam, photon_lasersegment *segment, glm::uvec2 location, const photon_level &level){
+    const photon_block *block_ptr = level::GetBlock(level, location);
+    if(block_ptr != nullptr && block_ptr->type != air){
+        const photon_block &block = *block_ptr;
+        const photon_block_traits &traits = GetTraits(block.type);
+
+        if(traits.records_hits){
+            AddHit(beam, segment, location);
+        }
+        if(traits.stops_beam){
             // stops tracing the laser.
             return nullptr;
-            break;
-        case mirror:
-        case mirror_locked:{
-            float angle = segment->angle - block.angle;
-            if(fmod(angle, 180.0f) == 0.0f){
-                return nullptr;
-            }
-            angle = fmod(angle + 180.0f, 360.0f) - 180.0f;
-            segment = tracer::CreateChildBeam(segment);
-            segment->angle = block.angle - angle;
-            break;
         }
-        case filter_red:{
-            glm::vec3 color = segment->color;
-            color.g = glm::min(color.g, 0.2f);
-            color.b = glm::min(color.b, 0.1f);
-            if(glm::length2(color) > 0.2f){
-                segment = tracer::CreateChildBeam(segment);
-                segment->color = color;
-            }else{
-                // stops tracing the laser.
+
+        if(block.type == mirror || block.type == mirror_locked){
+            uint8_t direction = mirror_reflections[segment->direction][block.rotation];
+            if(direction == mirror_blocked){
                 return nullptr;
             }
-            break;
-        }
-        case filter_green:{
+            segment = tracer::CreateChildBeam(beam, segment);
+            segment->direction = direction;
+        }else if(traits.color_mask != 0){
+            // a filter, (emitters & receivers stopped the beam already) takes out the colors not in its mask.
             glm::vec3 color = segment->color;
-            color.r = glm::min(color.r, 0.1f);
-            color.b = glm::min(color.b, 0.1f);
-            if(glm::length2(color) > 0.2f){
-                segment = tracer::CreateChildBeam(segment);
-                segment->color = color;
-            }else{
-                // stops tracing the laser.
-                return nullptr;
+            if(!(traits.color_mask & PHOTON_COLOR_RED)){
+                color.r = glm::min(color.r, 0.1f);
             }
-            break;
-        }
-        case filter_blue:{
-            glm::vec3 color = segment->color;
-            color.r = glm::min(color.r, 0.1f);
-            color.g = glm::min(color.g, 0.2f);
-            if(glm::length2(color) > 0.2f){
-                segment = tracer::CreateChildBeam(segment);
-                segment->color = color;
-            }else{
-                // stops tracing the laser.
-                return nullptr;
+            if(!(traits.color_mask & PHOTON_COLOR_GREEN)){
+                color.g = glm::min(color.g, 0.2f);
             }
-            break;
-        }
-        case filter_yellow:{
-            glm::vec3 color = segment->color;
-            color.b = glm::min(color.b, 0.1f);
-            if(glm::length2(color) > 0.2f){
-                segment = tracer::CreateChildBeam(segment);
-                segment->color = color;
-            }else{
-                // stops tracing the laser.
-                return nullptr;
+            if(!(traits.color_mask & PHOTON_COLOR_BLUE)){
+                color.b = glm::min(color.b, 0.1f);
             }
-            break;
-        }
-        case filter_cyan:{
-            glm::vec3 color = segment->color;
-            color.r = glm::min(color.r, 0.1f);
             if(glm::length2(color) > 0.2f){
-                segment = tracer::CreateChildBeam(segment);
+                segment = tracer::CreateChildBeam(beam, segment);
                 segment->color = color;
             }else{
                 // stops tracing the laser.
                 return nullptr;
             }
-            break;
         }
-        case filter_magenta:{
-            glm::vec3 color = segment->color;
-            color.g = glm::min(color.g, 0.2f);
-            if(glm::length2(color) > 0.2f){
-                segment = tracer::CreateChildBeam(segment);
-                segment->color = color;
-            }else{
-                // stops tracing the laser.
-                return nullptr;
+    }
+    return segment;
+}
+
+void OnLightHit(const photon_laserhit &hit, photon_level &level, float time){
+    photon_block *block_ptr = level::GetBlock(level, hit.location);
+    if(block_ptr != nullptr && block_ptr->type != air){
+        photon_block &block = *block_ptr;
+
+        // true if another beam already hit the block this frame.
+        bool already_hit = level::SetActivated(level, hit.location);
+
+        switch(block.type){
+        default:
+            break;
+        case receiver:
+            // goes through the level so it can keep count of powered receivers.
+            level::SetBlockPower(level, hit.location, block.power + 1.0f);
+            break;
+        case receiver_red:
+        case receiver_green:
+        case receiver_blue:
+        case receiver_white:{
+            // every color the receiver needs has to be bright enough.
+            uint8_t mask = GetTraits(block.type).color_mask;
+            if((!(mask & PHOTON_COLOR_RED)   || hit.color.r > 0.8f) &&
+               (!(mask & PHOTON_COLOR_GREEN) || hit.color.g > 0.8f) &&
+               (!(mask & PHOTON_COLOR_BLUE)  || hit.color.b > 0.8f)){
+                block.power++;
             }
             break;
         }
+        case tnt:
+            block.power += time;
+            break;
         case move:
-            if(!wasactivated){
-                block.angle = fmod(segment->angle + 360.0f, 360.0f);
+            // only the first beam to hit a move block each frame pushes it.
+            if(!already_hit){
+                block.rotation = hit.direction * 2;
                 block.power += time;
 
-                photon_level_coord newcoord(coord);
+                glm::uvec2 newlocation(hit.location);
 
-                if(block.angle == 0.0f){
-                    newcoord.first++;
-                }else if(block.angle == 90.0f){
-                    newcoord.second++;
-                }else if(block.angle == 180.0f){
-                    newcoord.first--;
-                }else if(block.angle == 270.0f){
-                    newcoord.second--;
+                if(block.rotation == 0){
+                    newlocation.x++;
+                }else if(block.rotation == 4){
+                    newlocation.y++;
+                }else if(block.rotation == 8){
+                    newlocation.x--;
+                }else if(block.rotation == 12){
+                    newlocation.y--;
                 }
 
-                if(!level.grid.count(newcoord)){
-                    break;
+                if(newlocation.x < level.width && newlocation.y < level.height){
+                    photon_block *destination = level::GetBlock(level, newlocation);
+                    if(destination == nullptr || destination->type == air){
+                        break;
+                    }
                 }
             }
-            block.angle = 0.0f;
+            block.rotation = 0;
             block.power = 0.0f;
             break;
         case move_reverse:
-            if(!wasactivated){
-                block.angle = fmod(segment->angle + 540.0f, 360.0f);
+            if(!already_hit){
+                block.rotation = ((hit.direction + PHOTON_DIRECTIONS / 2) % PHOTON_DIRECTIONS) * 2;
                 block.power += time;
 
-                photon_level_coord newcoord(coord);
+                glm::uvec2 newlocation(hit.location);
 
-                if(block.angle == 0.0f){
-                    newcoord.first++;
-                }else if(block.angle == 90.0f){
-                    newcoord.second++;
-                }else if(block.angle == 180.0f){
-                    newcoord.first--;
-                }else if(block.angle == 270.0f){
-                    newcoord.second--;
+                if(block.rotation == 0){
+                    newlocation.x++;
+                }else if(block.rotation == 4){
+                    newlocation.y++;
+                }else if(block.rotation == 8){
+                    newlocation.x--;
+                }else if(block.rotation == 12){
+                    newlocation.y--;
                 }
 
-                if(!level.grid.count(newcoord)){
-                    break;
+                if(newlocation.x < level.width && newlocation.y < level.height){
+                    photon_block *destination = level::GetBlock(level, newlocation);
+                    if(destination == nullptr || destination->type == air){
+                        break;
+                    }
                 }
             }
-            block.angle = 0.0f;
+            block.rotation = 0;
             block.power = 0.0f;
             break;
         }
     }
-    return segment;
 }
 
 void OnPhotonInteract(glm::uvec2 location, photon_level &level, photon_player &player){
-    photon_level_coord coord(location.x, location.y);
-    photon_block &block = level.grid[coord];
-    switch(block.type){
-    case air:
+    photon_block *block_ptr = level::GetBlock(level, location);
+    if(block_ptr == nullptr || block_ptr->type == air){
         if(player.current_item != invalid_block){
+            photon_block block;
             block.type = player.current_item;
-            player::AddItemCurrent(player, -1);
-            level.moves++;
+
+            if(level::SetBlock(level, location, block) != nullptr){
+                player::AddItemCurrent(player, -1);
+                level.moves++;
+            }
         }
-        break;
-    default:
-        break;
-    case tnt:
-    case filter_red:
-    case filter_green:
-    case filter_blue:
-    case filter_yellow:
-    case filter_cyan:
-    case filter_magenta:
-    case mirror:
+        return;
+    }
+    photon_block &block = *block_ptr;
+    if(GetTraits(block.type).pickable){
         if(!block.locked){
             player::AddItem(player, block.type);
-            level.grid.erase(coord);
+            level::ClearBlock(level, location);
             level.moves++;
         }
+        return;
+    }
+    switch(block.type){
+    default:
         break;
     case receiver:
     case receiver_red:
@@ -243,73 +250,70 @@ void OnPhotonInteract(glm::uvec2 location, photon_level &level, photon_player &p
         break;
     case move:
         if(!block.locked){
-            block.type = move_reverse;
             block.power = -block.power;
+            level::SetBlockType(level, location, move_reverse);
             level.moves++;
         }
         break;
     case move_reverse:
         if(!block.locked){
-            block.type = move;
             block.power = -block.power;
+            level::SetBlockType(level, location, move);
             level.moves++;
         }
         break;
     }
-    // if for some reason nothing happened to this block after it was added...
-    if(block.type == air){
-        level.grid.erase(coord);
-    }
 }
 
 void OnRotate(glm::uvec2 location, photon_level &level, bool counter_clockwise){
-    photon_level_coord coord(location.x, location.y);
-    if(level.grid.count(coord)){
-        photon_block &block = level.grid[coord];
-        switch(block.type){
-        case mirror:
+    photon_block *block_ptr = level::GetBlock(level, location);
+    if(block_ptr != nullptr){
+        photon_block &block = *block_ptr;
+        if(GetTraits(block.type).rotatable){
             if(counter_clockwise){
-                block.angle += 22.5f;
+                block.rotation = (block.rotation + 1) % PHOTON_ROTATION_STEPS;
             }else{
-                block.angle -= 22.5f;
+                block.rotation = (block.rotation + PHOTON_ROTATION_STEPS - 1) % PHOTON_ROTATION_STEPS;
             }
+            level::OnBlockChanged(level, location);
             level.moves++;
-        default:
-            break;
         }
     }
 }
 
 void OnRotate(glm::uvec2 location, photon_level &level, float to_angle){
-    photon_level_coord coord(location.x, location.y);
-    if(level.grid.count(coord)){
-        photon_block &block = level.grid[coord];
-        switch(block.type){
-        case mirror:{
-            float angle = round(to_angle / 22.5f) * 22.5f;
-            if(block.angle != angle){
-                block.angle = angle;
+    photon_block *block_ptr = level::GetBlock(level, location);
+    if(block_ptr != nullptr){
+        photon_block &block = *block_ptr;
+        if(GetTraits(block.type).rotatable){
+            uint8_t rotation = DegreesToRotation(to_angle);
+            if(block.rotation != rotation){
+                block.rotation = rotation;
+                level::OnBlockChanged(level, location);
                 level.moves++;
             }
         }
-        default:
-            break;
-        }
     }
 }
 
-void CreateBeam(photon_level &level, glm::vec3 color, glm::uvec2 location, float angle){
+uint8_t DegreesToRotation(float degrees){
+    int32_t rotation = int32_t(round(degrees / (360.0f / PHOTON_ROTATION_STEPS)));
+    return ((rotation % PHOTON_ROTATION_STEPS) + PHOTON_ROTATION_STEPS) % PHOTON_ROTATION_STEPS;
+}
+
+void CreateBeam(photon_level &level, glm::vec3 color, glm::uvec2 location, uint8_t rotation){
     level.beams.push_back(photon_laserbeam());
     photon_laserbeam &beam = level.beams.back();
     beam.color = color;
     beam.origin = location;
-    beam.origin_angle = angle;
+    // emitters can only fire in the 8 beam directions.
+    beam.origin_direction = rotation / 2;
 }
 
 void OnFrame(glm::uvec2 location, photon_level &level, float time){
-    photon_level_coord coord(location.x, location.y);
-    if(level.grid.count(coord)){
-        photon_block &block = level.grid[coord];
+    photon_block *block_ptr = level::GetBlock(level, location);
+    if(block_ptr != nullptr){
+        photon_block &block = *block_ptr;
         switch(block.type){
         default:
             break;
@@ -319,15 +323,15 @@ void OnFrame(glm::uvec2 location, photon_level &level, float time){
                 DamageAroundPoint(location, level, 4.0f);
                 // TODO - KABOOM goes here...
                 PrintToLog("INFO: KABOOM!");
-                block.type = tnt_fireball;
                 // cooldown of fireball
                 block.power = 1.0f;
+                level::SetBlockType(level, location, tnt_fireball);
                 break;
             }
             // if block was not activated last frame cool down timer.
-            if(!block.activated){
+            if(!level::WasActivated(level, location)){
                 block.power -= time;
-                block.power = std::max(block.power, 0.0f);
+                block.power = std::max(float(block.power), 0.0f);
             }
             break;
         case tnt_fireball:
@@ -335,88 +339,89 @@ void OnFrame(glm::uvec2 location, photon_level &level, float time){
             if(block.power > 0.4f){
                 DamageAroundPoint(location, level, 4.0f * (1.2f - block.power));
             }else if(block.power < 0.0f){
-#ifdef _MSC_VER
-                /* TODO - this is just a temporary workaround because MSVC's STL doesn't let you erase from within a range based for loop. */
-                block.type = air;
-#else
-                level.grid.erase(coord);
-#endif
+                level::ClearBlock(level, location);
             }
             break;
-        case emitter_white:{
-            CreateBeam(level, glm::vec3(0.9f), location, block.angle);
-            break;
-        }
-        case emitter_red:{
-            CreateBeam(level, glm::vec3(0.9f,0.2f,0.1f), location, block.angle);
-            break;
-        }
-        case emitter_green:{
-            CreateBeam(level, glm::vec3(0.1f,0.9f,0.2f), location, block.angle);
-            break;
-        }
-        case emitter_blue:{
-            CreateBeam(level, glm::vec3(0.1f,0.2f,0.9f), location, block.angle);
-            break;
-        }
         case receiver:
         case receiver_red:
         case receiver_green:
         case receiver_blue:
         case receiver_white:
-            block.power = 0.0f;
+            level::SetBlockPower(level, location, 0.0f);
             break;
         case move:
         case move_reverse:
-            if(!block.activated){
+            if(!level::WasActivated(level, location)){
                 block.power = 0.0f;
             }else if(block.power >= 0.8f){
                 block.power--;
 
-                photon_level_coord newcoord(coord);
+                glm::uvec2 newlocation(location);
 
-                if(block.angle == 0.0f){
-                    newcoord.first++;
-                }else if(block.angle == 90.0f){
-                    newcoord.second++;
-                }else if(block.angle == 180.0f){
-                    newcoord.first--;
-                }else if(block.angle == 270.0f){
-                    newcoord.second--;
+                if(block.rotation == 0){
+                    newlocation.x++;
+                }else if(block.rotation == 4){
+                    newlocation.y++;
+                }else if(block.rotation == 8){
+                    newlocation.x--;
+                }else if(block.rotation == 12){
+                    newlocation.y--;
                 }else{
                     break;
                 }
-                level.grid[newcoord] = block;
-
-#ifdef _MSC_VER
-                /* TODO - this is just a temporary workaround because MSVC's STL doesn't let you erase from within a range based for loop. */
-                block.type = air;
-#else
-                level.grid.erase(coord);
-#endif
+
+                if(level::SetBlock(level, newlocation, block) != nullptr){
+                    level::MoveActivation(level, location, newlocation);
+                    level::ClearBlock(level, location);
+                }
             }
             break;
         }
-        block.activated = false;
     }
 }
 
-void OnDamage(glm::uvec2 location, photon_level &level, float damage){
-    photon_level_coord coord(location.x, location.y);
-    if(level.grid.count(coord)){
-        photon_block &block = level.grid[coord];
+bool NeedsFrameUpdate(block_type type){
+    return GetTraits(type).needs_frame_update;
+}
+
+void EmitBeam(glm::uvec2 location, photon_level &level){
+    const photon_block *block_ptr = level::GetBlock(level, location);
+    if(block_ptr != nullptr){
+        const photon_block &block = *block_ptr;
         switch(block.type){
-        case plain:
-        case target:
+        default:
+            break;
+        case emitter_white:{
+            CreateBeam(level, glm::vec3(0.9f), location, block.rotation);
+            break;
+        }
+        case emitter_red:{
+            CreateBeam(level, glm::vec3(0.9f,0.2f,0.1f), location, block.rotation);
+            break;
+        }
+        case emitter_green:{
+            CreateBeam(level, glm::vec3(0.1f,0.9f,0.2f), location, block.rotation);
+            break;
+        }
+        case emitter_blue:{
+            CreateBeam(level, glm::vec3(0.1f,0.2f,0.9f), location, block.rotation);
+            break;
+        }
+        }
+    }
+}
+
+void OnDamage(glm::uvec2 location, photon_level &level, float damage){
+    photon_block *block_ptr = level::GetBlock(level, location);
+    if(block_ptr != nullptr){
+        photon_block &block = *block_ptr;
+        if(GetTraits(block.type).destructible){
             if(damage > 0.5f){
-                level.grid.erase(coord);
+                level::ClearBlock(level, location);
             }
-            break;
-        case tnt:
+        }else if(block.type == tnt){
             // will make explosions trigger nearby TNT...
             block.power += damage;
-        default:
-            break;
         }
     }
 }
@@ -433,76 +438,55 @@ void DamageAroundPoint(glm::uvec2 location, photon_level &level, float strength)
         }
     }
 }
-#define CASESTR(X) case X: return #X; break;
-
 const char* GetBlockName(block_type type){
-    switch(type){
-    default:
-        CASESTR(invalid_block);
-        CASESTR(air);
-        CASESTR(mirror);
-        CASESTR(mirror_locked);
-        CASESTR(plain);
-        CASESTR(indestructible);
-        CASESTR(emitter_white);
-        CASESTR(emitter_red);
-        CASESTR(emitter_green);
-        CASESTR(emitter_blue);
-        CASESTR(receiver);
-        CASESTR(receiver_white);
-        CASESTR(receiver_red);
-        CASESTR(receiver_green);
-        CASESTR(receiver_blue);
-        CASESTR(target);
-        CASESTR(tnt);
-        CASESTR(tnt_fireball);
-        CASESTR(filter_red);
-        CASESTR(filter_green);
-        CASESTR(filter_blue);
-        CASESTR(filter_yellow);
-        CASESTR(filter_cyan);
-        CASESTR(filter_magenta);
-        CASESTR(move);
-        CASESTR(move_reverse);
+    if(type >= air && type < block_type_count){
+        return block_traits[type].name;
     }
+    return "invalid_block";
+}
+
+// seed for the name hash, chosen so that no two block names land in the same slot of name_table.
+// if a new block name collides the static_assert below fails, try seeds until it doesn't.
+#define PHOTON_BLOCK_NAME_SEED 120u
+#define PHOTON_BLOCK_NAME_BITS 6
+
+// FNV-1a, with the seed mixed into the offset basis, returns the top PHOTON_BLOCK_NAME_BITS bits.
+constexpr uint32_t HashBlockName(const char *name, uint32_t hash = 2166136261u ^ PHOTON_BLOCK_NAME_SEED){
+    return *name == '\0' ? hash >> (32 - PHOTON_BLOCK_NAME_BITS) : HashBlockName(name + 1, (hash ^ uint8_t(*name)) * 16777619u);
+}
+
+constexpr bool NameHashDiffers(uint32_t hash, uint32_t i){
+    return i == block_type_count || (HashBlockName(block_traits[i].name) != hash && NameHashDiffers(hash, i + 1));
+}
+constexpr bool NameHashesUnique(uint32_t i = 0){
+    return i == block_type_count || (NameHashDiffers(HashBlockName(block_traits[i].name), i + 1) && NameHashesUnique(i + 1));
 }
-#undef CASESTR
-#define CASESTR(X) if(!strcmp(name, #X)){ return X; }
+static_assert(NameHashesUnique(), "two block names have the same hash, change PHOTON_BLOCK_NAME_SEED.");
 
 block_type GetBlockFromName(const char* name){
-    CASESTR(invalid_block)
-    else CASESTR(air)
-    else CASESTR(mirror)
-    else CASESTR(mirror_locked)
-    else CASESTR(plain)
-    else CASESTR(indestructible)
-    else CASESTR(emitter_white)
-    else CASESTR(emitter_red)
-    else CASESTR(emitter_green)
-    else CASESTR(emitter_blue)
-    else CASESTR(receiver)
-    else CASESTR(receiver_white)
-    else CASESTR(receiver_red)
-    else CASESTR(receiver_green)
-    else CASESTR(receiver_blue)
-    else CASESTR(target)
-    else CASESTR(tnt)
-    else CASESTR(tnt_fireball)
-    else CASESTR(filter_red)
-    else CASESTR(filter_green)
-    else CASESTR(filter_blue)
-    else CASESTR(filter_yellow)
-    else CASESTR(filter_cyan)
-    else CASESTR(filter_magenta)
-    else CASESTR(move)
-    else CASESTR(move_reverse)
-    else{
+    // block type for each hash, invalid_block for slots no name hashes to.
+    struct name_table{
+        block_type types[1 << PHOTON_BLOCK_NAME_BITS];
+
+        name_table(){
+            std::fill(std::begin(types), std::end(types), invalid_block);
+            for(const photon_block_traits &traits : block_traits){
+                types[HashBlockName(traits.name)] = traits.type;
+            }
+        }
+    };
+    static const name_table table;
+
+    if(name == nullptr){
         return invalid_block;
     }
+    block_type type = table.types[HashBlockName(name)];
+    if(type != invalid_block && strcmp(block_traits[type].name, name) == 0){
+        return type;
+    }
+    return invalid_block;
 }
 
-#undef CASESTR
-
 }
 
 }
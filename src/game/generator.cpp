@@ -0,0 +1,126 @@
+#include "photon_sim.h"
+
+namespace photon{
+
+namespace generator{
+
+// splitmix64, the standard library distributions aren't the same everywhere so levels wouldn't match between platforms.
+uint64_t NextRandom(uint64_t &state){
+    uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+// from 0 to 1, not including 1.
+float RandomFloat(uint64_t &state){
+    return (NextRandom(state) >> 40) * (1.0f / 16777216.0f);
+}
+
+uint32_t RandomInt(uint64_t &state, uint32_t range){
+    return uint32_t(NextRandom(state) % range);
+}
+
+void Generate(const photon_generator_settings &settings, photon_level &level, photon_player &player){
+    static const block_type filters[] = { filter_red, filter_green, filter_blue, filter_yellow, filter_cyan, filter_magenta };
+
+    uint64_t state = settings.seed;
+
+    uint32_t w = std::min(std::max(settings.width,  1u), uint32_t(PHOTON_LEVEL_MAX_SIZE));
+    uint32_t h = std::min(std::max(settings.height, 1u), uint32_t(PHOTON_LEVEL_MAX_SIZE));
+
+    level = photon_level();
+    lua::Reset();
+
+    level::ResizeGrid(level, w + 2, h + 2);
+    level::FillBorder(level);
+
+    for(uint32_t y = 1; y <= h; y++){
+        for(uint32_t x = 1; x <= w; x++){
+            float r = RandomFloat(state);
+            photon_block block;
+
+            if(r < settings.mirror_density){
+                block.type = mirror;
+                block.rotation = RandomInt(state, PHOTON_ROTATION_STEPS);
+            }else if(r < settings.mirror_density + settings.filter_density){
+                block.type = filters[RandomInt(state, sizeof(filters) / sizeof(*filters))];
+            }else{
+                continue;
+            }
+
+            level::SetBlock(level, glm::uvec2(x, y), block);
+        }
+    }
+
+    auto random_location = [&](){
+        return glm::uvec2(1 + RandomInt(state, w), 1 + RandomInt(state, h));
+    };
+
+    for(uint32_t i = 0; i < settings.emitters && !settings.emitter_types.empty(); i++){
+        photon_block block;
+        // only use up a random number when there is a choice, so single color levels stay the same.
+        if(settings.emitter_types.size() > 1){
+            block.type = settings.emitter_types[RandomInt(state, settings.emitter_types.size())];
+        }else{
+            block.type = settings.emitter_types.front();
+        }
+        // emitters can only fire in the 8 beam directions.
+        block.rotation = RandomInt(state, PHOTON_DIRECTIONS) * 2;
+
+        level::SetBlock(level, random_location(), block);
+    }
+
+    for(uint32_t i = 0; i < settings.receivers; i++){
+        photon_block block;
+        block.type = receiver;
+        block.rotation = RandomInt(state, PHOTON_DIRECTIONS) * 2;
+
+        level::SetBlock(level, random_location(), block);
+    }
+
+    for(uint32_t i = 0; i < settings.targets; i++){
+        photon_block block;
+        block.type = target;
+
+        level::SetBlock(level, random_location(), block);
+    }
+
+    uint32_t cluster_size = std::max(settings.tnt_cluster_size, 1u);
+    for(uint32_t i = 0; i < settings.tnt_clusters; i++){
+        glm::uvec2 corner = random_location();
+        photon_block block;
+        block.type = tnt;
+
+        // fill about half the square.
+        for(uint32_t j = 0; j < cluster_size * cluster_size; j++){
+            glm::uvec2 location = corner + glm::uvec2(RandomInt(state, cluster_size), RandomInt(state, cluster_size));
+            if(RandomInt(state, 2) == 0 && location.x <= w && location.y <= h){
+                level::SetBlock(level, location, block);
+            }
+        }
+    }
+
+    for(uint32_t i = 0; i < settings.move_blocks; i++){
+        photon_block block;
+        block.type = RandomInt(state, 2) == 0 ? move : move_reverse;
+        // move blocks only go straight up, down, left or right.
+        block.rotation = RandomInt(state, 4) * 4;
+
+        level::SetBlock(level, random_location(), block);
+    }
+
+    player = photon_player();
+    player.location = glm::vec2(level.width, level.height) * 0.5f;
+    player::GiveInfiniteItems(player, mirror);
+
+    level.mode = settings.mode;
+    level.goal = settings.goal;
+    level.is_valid = true;
+
+    PrintToLog("INFO: Generated %u x %u level from seed %llu.", w, h, (unsigned long long)settings.seed);
+}
+
+}
+
+}
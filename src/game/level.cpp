@@ -1,42 +1,489 @@
-#include "photon_core.h"
-#include "photon_lua.h"
+#include "photon_sim.h"
+
+#include <atomic>
 
 namespace photon{
 
 namespace level{
 
-void Draw(photon_level &level){
-    for(auto &block : level.grid){
-        blocks::Draw(block.second, glm::vec2(block.first.first, block.first.second));
+void ResizeGrid(photon_level &level, uint32_t width, uint32_t height){
+    level.width = width;
+    level.height = height;
+
+    level.grid.clear();
+    level.occupancy = photon_level_occupancy();
+    level.active_blocks.clear();
+    level.activated_chunks.clear();
+    level.was_activated_chunks.clear();
+    std::fill(std::begin(level.block_counts), std::end(level.block_counts), 0);
+    level.powered_receivers = 0;
+    level.beams.clear();
+    level.beam_index.clear();
+    level.emitters_changed = true;
+}
+
+void FillBorder(photon_level &level){
+    photon_block border;
+    border.type = indestructible;
+
+    for(uint32_t x = 0; x < level.width; x++){
+        SetBlock(level, glm::uvec2(x, 0               ), border);
+        SetBlock(level, glm::uvec2(x, level.height - 1), border);
+    }
+    for(uint32_t y = 0; y < level.height; y++){
+        SetBlock(level, glm::uvec2(0,               y), border);
+        SetBlock(level, glm::uvec2(level.width - 1, y), border);
     }
 }
 
-void DrawBeams(photon_level &level){
-    for(photon_laserbeam &beam : level.beams){
-        opengl::DrawLaser(beam);
+uint64_t ChunkKey(glm::uvec2 location){
+    return (uint64_t(location.y >> PHOTON_CHUNK_SHIFT) << 32) | (location.x >> PHOTON_CHUNK_SHIFT);
+}
+
+inline uint32_t ChunkIndex(glm::uvec2 location){
+    return (location.y & PHOTON_CHUNK_MASK) * PHOTON_CHUNK_SIZE + (location.x & PHOTON_CHUNK_MASK);
+}
+
+uint64_t ActiveKey(glm::uvec2 location){
+    // chunk y gets the top 24 bits, chunk x the next 32 & the index in the chunk the bottom 8.
+    return (uint64_t(location.y >> PHOTON_CHUNK_SHIFT) << 40) | (uint64_t(location.x >> PHOTON_CHUNK_SHIFT) << 8) | ChunkIndex(location);
+}
+
+glm::uvec2 ActiveKeyLocation(uint64_t key){
+    uint32_t index = key & 0xff;
+    return glm::uvec2((uint32_t(key >> 8) << PHOTON_CHUNK_SHIFT) + index % PHOTON_CHUNK_SIZE,
+                      (uint32_t(key >> 40) << PHOTON_CHUNK_SHIFT) + index / PHOTON_CHUNK_SIZE);
+}
+
+void SetOccupied(photon_level_occupancy &occupancy, glm::uvec2 location){
+    occupancy.rows[location.y].insert(location.x);
+    occupancy.columns[location.x].insert(location.y);
+    occupancy.diagonals[location.x - location.y].insert(location.x);
+    occupancy.antidiagonals[location.x + location.y].insert(location.x);
+}
+
+void ClearOccupied(std::unordered_map<uint32_t, std::set<uint32_t>> &lines, uint32_t line, uint32_t position){
+    auto positions = lines.find(line);
+    if(positions != lines.end()){
+        positions->second.erase(position);
+        if(positions->second.empty()){
+            lines.erase(positions);
+        }
     }
 }
 
-void DrawBeamsLight(photon_level &level){
-    for(photon_laserbeam &beam : level.beams){
-        opengl::DrawLaserLight(beam);
+void ClearOccupied(photon_level_occupancy &occupancy, glm::uvec2 location){
+    ClearOccupied(occupancy.rows, location.y, location.x);
+    ClearOccupied(occupancy.columns, location.x, location.y);
+    ClearOccupied(occupancy.diagonals, location.x - location.y, location.x);
+    ClearOccupied(occupancy.antidiagonals, location.x + location.y, location.x);
+}
+
+inline bool IsEmitter(block_type type){
+    return type == emitter_white || type == emitter_red || type == emitter_green || type == emitter_blue;
+}
+
+inline bool IsPoweredReceiver(const photon_block &block){
+    return block.type == receiver && block.power >= PHOTON_RECEIVER_POWERED;
+}
+
+// adds (or removes if amount is negative) block to the counts used by CheckVictory().
+void CountBlock(photon_level &level, const photon_block &block, int32_t amount){
+    if(block.type > air && block.type < block_type_count){
+        level.block_counts[block.type] += amount;
+    }
+    if(IsPoweredReceiver(block)){
+        level.powered_receivers += amount;
     }
 }
 
-void DrawFX(photon_level &level){
-    for(auto &block : level.grid){
-        blocks::DrawFX(block.second, glm::vec2(block.first.first, block.first.second));
+photon_block *GetBlock(photon_level &level, glm::uvec2 location){
+    if(location.x >= level.width || location.y >= level.height){
+        return nullptr;
     }
+    auto chunk = level.grid.find(ChunkKey(location));
+    if(chunk == level.grid.end()){
+        return nullptr;
+    }
+    return &chunk->second.blocks[ChunkIndex(location)];
 }
 
-void AdvanceFrame(photon_level &level, photon_player &player, float time){
-    level.beams.clear();
-    for(auto &block : level.grid){
-        blocks::OnFrame(glm::uvec2(block.first.first, block.first.second), level, time);
+const photon_block *GetBlock(const photon_level &level, glm::uvec2 location){
+    if(location.x >= level.width || location.y >= level.height){
+        return nullptr;
+    }
+    auto chunk = level.grid.find(ChunkKey(location));
+    if(chunk == level.grid.end()){
+        return nullptr;
+    }
+    return &chunk->second.blocks[ChunkIndex(location)];
+}
+
+photon_block *SetBlock(photon_level &level, glm::uvec2 location, const photon_block &block){
+    if(location.x >= level.width || location.y >= level.height){
+        return nullptr;
+    }
+    photon_level_chunk &chunk = level.grid[ChunkKey(location)];
+    chunk.origin = glm::uvec2(location.x & ~PHOTON_CHUNK_MASK, location.y & ~PHOTON_CHUNK_MASK);
+
+    photon_block &current = chunk.blocks[ChunkIndex(location)];
+    if(current.type == air && block.type != air){
+        chunk.block_count++;
+        SetOccupied(level.occupancy, location);
+    }else if(current.type != air && block.type == air){
+        chunk.block_count--;
+        ClearOccupied(level.occupancy, location);
+    }
+    if(IsEmitter(current.type) || IsEmitter(block.type)){
+        level.emitters_changed = true;
+    }
+    if(blocks::NeedsFrameUpdate(block.type)){
+        level.active_blocks.insert(ActiveKey(location));
+    }else if(blocks::NeedsFrameUpdate(current.type)){
+        level.active_blocks.erase(ActiveKey(location));
+    }
+    CountBlock(level, current, -1);
+    CountBlock(level, block, 1);
+    current = block;
+
+    OnBlockChanged(level, location);
+
+    return &current;
+}
+
+void ClearBlock(photon_level &level, glm::uvec2 location){
+    auto chunk = level.grid.find(ChunkKey(location));
+    if(chunk != level.grid.end()){
+        photon_block &block = chunk->second.blocks[ChunkIndex(location)];
+        if(block.type != air){
+            if(IsEmitter(block.type)){
+                level.emitters_changed = true;
+            }
+            if(blocks::NeedsFrameUpdate(block.type)){
+                level.active_blocks.erase(ActiveKey(location));
+            }
+            CountBlock(level, block, -1);
+            block = photon_block();
+            chunk->second.block_count--;
+            ClearOccupied(level.occupancy, location);
+
+            OnBlockChanged(level, location);
+        }
+    }
+}
+
+void SetBlockType(photon_level &level, glm::uvec2 location, block_type type){
+    photon_block *block = GetBlock(level, location);
+    if(block != nullptr && block->type != air){
+        photon_block changed = *block;
+        changed.type = type;
+        SetBlock(level, location, changed);
+    }
+}
+
+void SetBlockPower(photon_level &level, glm::uvec2 location, float power){
+    photon_block *block = GetBlock(level, location);
+    if(block != nullptr){
+        CountBlock(level, *block, -1);
+        block->power = power;
+        CountBlock(level, *block, 1);
+    }
+}
+
+bool SetActivated(photon_level &level, glm::uvec2 location){
+    if(location.x >= level.width || location.y >= level.height){
+        return false;
+    }
+    auto chunk = level.grid.find(ChunkKey(location));
+    if(chunk == level.grid.end()){
+        return false;
+    }
+    uint32_t index = ChunkIndex(location);
+    uint64_t &word = chunk->second.activated[index / 64];
+    uint64_t bit = uint64_t(1) << (index % 64);
+
+    if(word & bit){
+        return true;
+    }
+    if(std::all_of(std::begin(chunk->second.activated), std::end(chunk->second.activated), [](uint64_t w){ return w == 0; })){
+        level.activated_chunks.push_back(chunk->first);
+    }
+    word |= bit;
+    return false;
+}
+
+bool WasActivated(const photon_level &level, glm::uvec2 location){
+    if(location.x >= level.width || location.y >= level.height){
+        return false;
+    }
+    auto chunk = level.grid.find(ChunkKey(location));
+    if(chunk == level.grid.end()){
+        return false;
+    }
+    uint32_t index = ChunkIndex(location);
+    return (chunk->second.was_activated[index / 64] >> (index % 64)) & 1;
+}
+
+void MoveActivation(photon_level &level, glm::uvec2 from, glm::uvec2 to){
+    if(!WasActivated(level, from)){
+        return;
+    }
+    auto chunk = level.grid.find(ChunkKey(to));
+    if(chunk != level.grid.end()){
+        uint32_t index = ChunkIndex(to);
+        chunk->second.was_activated[index / 64] |= uint64_t(1) << (index % 64);
+        level.was_activated_chunks.push_back(chunk->first);
+    }
+}
+
+void SwapActivation(photon_level &level){
+    // chunks may have been freed since they were added.
+    for(uint64_t key : level.was_activated_chunks){
+        auto chunk = level.grid.find(key);
+        if(chunk != level.grid.end()){
+            std::fill(std::begin(chunk->second.was_activated), std::end(chunk->second.was_activated), 0);
+        }
+    }
+    for(uint64_t key : level.activated_chunks){
+        auto chunk = level.grid.find(key);
+        if(chunk != level.grid.end()){
+            photon_level_chunk &c = chunk->second;
+            for(uint32_t i = 0; i < PHOTON_CHUNK_WORDS; i++){
+                c.was_activated[i] |= c.activated[i];
+                c.activated[i] = 0;
+            }
+        }
+    }
+    std::swap(level.was_activated_chunks, level.activated_chunks);
+    level.activated_chunks.clear();
+}
+
+uint32_t GetBlockCount(const photon_level &level, block_type type){
+    if(type > air && type < block_type_count){
+        return level.block_counts[type];
+    }
+    return 0;
+}
+
+uint32_t GetBlockCount(const photon_level &level){
+    uint32_t count = 0;
+    for(uint32_t type = air + 1; type < block_type_count; type++){
+        count += level.block_counts[type];
+    }
+    return count;
+}
+
+// shared by every level so a chunk never gets a version a chunk of another level had.
+static std::atomic<uint64_t> chunk_version(0);
+
+void OnBlockChanged(photon_level &level, glm::uvec2 location){
+    auto chunk = level.grid.find(ChunkKey(location));
+    if(chunk != level.grid.end()){
+        chunk->second.version = ++chunk_version;
+    }
+
+    auto segments = level.beam_index.find(ChunkKey(location));
+    if(segments != level.beam_index.end()){
+        for(photon_segment_ref ref : segments->second){
+            photon_laserbeam &beam = level.beams[ref.beam];
+            if(!beam.dirty && tracer::PassesThrough(beam.segments[ref.segment], location)){
+                beam.dirty = true;
+            }
+        }
+    }
+}
+
+bool FindNextBlock(const photon_level &level, glm::uvec2 location, glm::ivec2 direction, glm::uvec2 &found){
+    const std::unordered_map<uint32_t, std::set<uint32_t>> *lines;
+    uint32_t line;
+    // position along the line & which way the direction goes along it.
+    uint32_t position = location.x;
+    int32_t along = direction.x;
+
+    if(direction.y == 0){
+        lines = &level.occupancy.rows;
+        line = location.y;
+    }else if(direction.x == 0){
+        lines = &level.occupancy.columns;
+        line = location.x;
+        position = location.y;
+        along = direction.y;
+    }else if(direction.x == direction.y){
+        lines = &level.occupancy.diagonals;
+        line = location.x - location.y;
+    }else{
+        lines = &level.occupancy.antidiagonals;
+        line = location.x + location.y;
+    }
+
+    auto positions = lines->find(line);
+    if(positions != lines->end()){
+        if(along > 0){
+            auto next = positions->second.upper_bound(position);
+            if(next != positions->second.end()){
+                found = glm::uvec2(glm::ivec2(location) + direction * int32_t(*next - position));
+                return true;
+            }
+        }else{
+            auto next = positions->second.lower_bound(position);
+            if(next != positions->second.begin()){
+                --next;
+                found = glm::uvec2(glm::ivec2(location) + direction * int32_t(position - *next));
+                return true;
+            }
+        }
+    }
+
+    // nothing in the way, go to the edge of the level.
+    uint32_t distance = UINT32_MAX;
+    if(direction.x > 0){
+        distance = std::min(distance, level.width - 1 - location.x);
+    }else if(direction.x < 0){
+        distance = std::min(distance, location.x);
+    }
+    if(direction.y > 0){
+        distance = std::min(distance, level.height - 1 - location.y);
+    }else if(direction.y < 0){
+        distance = std::min(distance, location.y);
+    }
+    found = glm::uvec2(glm::ivec2(location) + direction * int32_t(distance));
+    return false;
+}
+
+void FreeEmptyChunks(photon_level &level){
+    for(auto chunk = level.grid.begin(); chunk != level.grid.end();){
+        if(chunk->second.block_count == 0){
+            chunk = level.grid.erase(chunk);
+        }else{
+            ++chunk;
+        }
+    }
+}
+
+template<typename T, typename C>
+std::vector<T*> SortChunks(C &grid){
+    std::vector<T*> chunks;
+    chunks.reserve(grid.size());
+
+    for(auto &chunk : grid){
+        chunks.push_back(&chunk.second);
+    }
+    std::sort(chunks.begin(), chunks.end(), [](T *a, T *b){
+        return a->origin.y < b->origin.y || (a->origin.y == b->origin.y && a->origin.x < b->origin.x);
+    });
+    return chunks;
+}
+
+std::vector<photon_level_chunk*> GetSortedChunks(photon_level &level){
+    return SortChunks<photon_level_chunk>(level.grid);
+}
+
+std::vector<const photon_level_chunk*> GetSortedChunks(const photon_level &level){
+    return SortChunks<const photon_level_chunk>(level.grid);
+}
+
+void RemoveFromBeamIndex(photon_level &level, uint32_t index){
+    for(const photon_laserchunk &chunk : level.beams[index].chunks){
+        auto segments = level.beam_index.find(chunk.key);
+        if(segments != level.beam_index.end()){
+            segments->second.erase(std::remove_if(segments->second.begin(), segments->second.end(), [index](photon_segment_ref ref){
+                return ref.beam == index;
+            }), segments->second.end());
+            if(segments->second.empty()){
+                level.beam_index.erase(segments);
+            }
+        }
     }
+}
+
+void UpdateBeams(photon_level &level, float time){
+    PHOTON_PROFILE_ZONE("level::UpdateBeams");
+    if(level.emitters_changed){
+        level.beams.clear();
+        level.beam_index.clear();
+
+        for(photon_level_chunk *chunk : GetSortedChunks(level)){
+            for(uint32_t i = 0; i < PHOTON_CHUNK_SIZE * PHOTON_CHUNK_SIZE; i++){
+                if(chunk->blocks[i].type != air){
+                    blocks::EmitBeam(chunk->origin + glm::uvec2(i % PHOTON_CHUNK_SIZE, i / PHOTON_CHUNK_SIZE), level);
+                }
+            }
+        }
+        level.emitters_changed = false;
+        level.trace_start = 0;
+    }
+
+    // only beams that went through a changed block need to be traced again.
+    std::vector<uint32_t> dirty;
+    std::vector<photon_laserbeam*> dirty_beams;
+    uint32_t budget = tracer::GetTraceBudget();
+    uint64_t cost = 0;
+    uint32_t beam_count = level.beams.size();
+    for(uint32_t n = 0; n < beam_count; n++){
+        uint32_t i = (level.trace_start + n) % beam_count;
+        if(level.beams[i].dirty){
+            // guess the cost from the last trace, the rest wait for next frame. (keeping their old paths until then)
+            cost += std::max(level.beams[i].steps, 1u);
+            if(budget != 0 && !dirty.empty() && cost > budget){
+                level.trace_start = i;
+                break;
+            }
+            RemoveFromBeamIndex(level, i);
+
+            dirty.push_back(i);
+            dirty_beams.push_back(&level.beams[i]);
+        }
+    }
+
+    if(!dirty.empty()){
+        tracer::TraceBeams(dirty_beams, level, budget);
+
+        bool cut_short = false;
+        for(uint32_t i : dirty){
+            photon_laserbeam &beam = level.beams[i];
+            for(const photon_laserchunk &chunk : beam.chunks){
+                level.beam_index[chunk.key].push_back({i, chunk.segment});
+            }
+
+            if(beam.closed_loop){
+                PrintToLog("WARNING: beam from %u,%u is a closed loop, stopped tracing it after %u blocks.", beam.origin.x, beam.origin.y, beam.steps);
+            }else if(beam.truncated){
+                if(beam.steps < budget){
+                    // the beams before it used up the budget, it gets traced again first thing next frame.
+                    beam.dirty = true;
+                    if(!cut_short){
+                        level.trace_start = i;
+                        cut_short = true;
+                    }
+                }else{
+                    PrintToLog("WARNING: beam from %u,%u is longer than the trace budget, stopped tracing it after %u blocks.", beam.origin.x, beam.origin.y, beam.steps);
+                }
+            }
+        }
+    }
+
+    PHOTON_PROFILE_ZONE("tracer::ApplyBeam");
+    // hits get applied in beam order no matter how the beams were traced.
     for(photon_laserbeam &beam : level.beams){
-        tracer::TraceBeam(beam, level, time);
+        tracer::ApplyBeam(beam, level, time);
+    }
+}
+
+void AdvanceFrame(photon_level &level, photon_player &player, float time){
+    PHOTON_PROFILE_ZONE("level::AdvanceFrame");
+    SwapActivation(level);
+    {
+        PHOTON_PROFILE_ZONE("blocks::OnFrame");
+        // OnFrame() can add & remove active blocks, so look up the next one after each call instead of holding an iterator.
+        for(auto active = level.active_blocks.begin(); active != level.active_blocks.end();){
+            uint64_t key = *active;
+            blocks::OnFrame(ActiveKeyLocation(key), level, time);
+            active = level.active_blocks.upper_bound(key);
+        }
     }
+    UpdateBeams(level, time);
+
+    FreeEmptyChunks(level);
 
     level.time += time;
 
@@ -48,6 +495,99 @@ void AdvanceFrame(photon_level &level, photon_player &player, float time){
     }
 }
 
+void SaveTickState(photon_level &level){
+    // active_blocks is sorted, so previous_power comes out sorted too.
+    level.previous_power.clear();
+    for(uint64_t key : level.active_blocks){
+        const photon_block *block = GetBlock(level, ActiveKeyLocation(key));
+        if(block != nullptr){
+            level.previous_power.push_back(std::make_pair(key, float(block->power)));
+        }
+    }
+}
+
+float GetPreviousPower(const photon_level &level, glm::uvec2 location, float current_power){
+    uint64_t key = ActiveKey(location);
+    auto previous = std::lower_bound(level.previous_power.begin(), level.previous_power.end(), key, [](const std::pair<uint64_t, float> &a, uint64_t key){
+        return a.first < key;
+    });
+    if(previous != level.previous_power.end() && previous->first == key){
+        return previous->second;
+    }
+    return current_power;
+}
+
+void QueueAction(photon_level &level, const photon_level_action &action){
+    level.actions.push_back(action);
+}
+
+void DoActions(photon_level &level, photon_player &player){
+    // actions can replace the level (winning), so work from a copy.
+    std::vector<photon_level_action> actions;
+    actions.swap(level.actions);
+
+    for(const photon_level_action &action : actions){
+        if(!level.is_valid){
+            break;
+        }
+        switch(action.type){
+        case photon_level_action::interact:
+            blocks::OnPhotonInteract(action.location, level, player);
+            break;
+        case photon_level_action::rotate:
+            blocks::OnRotate(action.location, level);
+            break;
+        case photon_level_action::rotate_counter_clockwise:
+            blocks::OnRotate(action.location, level, true);
+            break;
+        case photon_level_action::rotate_to:
+            blocks::OnRotate(action.location, level, action.angle);
+            break;
+        }
+    }
+
+    // hand the memory back if the level wasn't replaced.
+    if(level.actions.empty()){
+        actions.clear();
+        level.actions.swap(actions);
+    }
+}
+
+uint32_t RunTicks(photon_timestep &timestep, photon_level &level, photon_player &player, float frame_time){
+    if(!level.is_valid){
+        timestep.accumulator = 0.0f;
+        return 0;
+    }
+    timestep.accumulator += frame_time;
+
+    uint32_t count = 0;
+    while(timestep.accumulator >= timestep.tick && level.is_valid){
+        if(count >= timestep.max_ticks){
+            // too far behind to catch up, drop the rest instead of making the next frame even slower.
+            timestep.dropped_ticks += uint64_t(timestep.accumulator / timestep.tick);
+            timestep.accumulator = std::fmod(timestep.accumulator, timestep.tick);
+            break;
+        }
+        if(!level.actions.empty()){
+            DoActions(level, player);
+            if(!level.is_valid){
+                break;
+            }
+        }
+        SaveTickState(level);
+        AdvanceFrame(level, player, timestep.tick);
+
+        timestep.accumulator -= timestep.tick;
+        timestep.ticks++;
+        count++;
+    }
+    return count;
+}
+
+float GetInterpolation(const photon_timestep &timestep){
+    return glm::clamp(timestep.accumulator / timestep.tick, 0.0f, 1.0f);
+}
+
 int8_t SetVictoryState(photon_level &level, int8_t victory){
     level.end_time = level.time;
     level.victory_state = victory;
@@ -55,55 +595,39 @@ int8_t SetVictoryState(photon_level &level, int8_t victory){
 }
 
 int8_t CheckVictory(photon_level &level, photon_player &player){
+    PHOTON_PROFILE_ZONE("level::CheckVictory");
     if(level.victory_state == 0){
         switch(level.mode){
         case photon_level::none:
             return SetVictoryState(level, 1);
             break;
-        case photon_level::power:{
-            for(auto &block : level.grid){
-                if(block.second.type == receiver){
-                    // if any receiver is not powered return false.
-                    if(block.second.power < 0.9f){
-                        return 0;
-                    }
-                }
+        case photon_level::power:
+            // if any receiver is not powered return false.
+            if(level.powered_receivers < level.block_counts[receiver]){
+                return 0;
             }
             return SetVictoryState(level, 1);
             break;
-        }
         case photon_level::targets:
-            for(auto &block : level.grid){
-                if(block.second.type == target){
-                    // if there is any target in existense return false.
-                    return 0;
-                }
+            // if there is any target in existense return false.
+            if(level.block_counts[target] > 0){
+                return 0;
             }
             return SetVictoryState(level, 1);
             break;
         case photon_level::destruction:
-            for(auto &block : level.grid){
-                if(block.second.type == plain || block.second.type == tnt || block.second.type == target){
-                    // if there is any destructible block in existense return false.
-                    return 0;
-                }
+            // if there is any destructible block in existense return false.
+            if(level.block_counts[plain] > 0 || level.block_counts[tnt] > 0 || level.block_counts[target] > 0){
+                return 0;
             }
             return SetVictoryState(level, 1);
             break;
         case photon_level::tnt_harvester:
             if(player::GetItemCount(player, tnt) >= level.goal){
                 return SetVictoryState(level, 1);
-            }else{
-                int32_t tnt_count = 0;
-                for(auto block : level.grid){
-                    if(block.second.type == tnt){
-                        tnt_count++;
-                    }
-                }
-                if(player::GetItemCount(player, tnt) + tnt_count < level.goal){
-                    // not enough tnt in inventory or level, game cannot be won.
-                    return SetVictoryState(level, -1);
-                }
+            }else if(player::GetItemCount(player, tnt) + int32_t(level.block_counts[tnt]) < level.goal){
+                // not enough tnt in inventory or level, game cannot be won.
+                return SetVictoryState(level, -1);
             }
             break;
         case photon_level::script:
@@ -1,5 +1,4 @@
-#include "photon_core.h"
-#include "photon_lua.h"
+#include "photon_sim.h"
 
 #include <physfs.h>
 #include <libxml/parser.h>
@@ -8,9 +7,44 @@ namespace photon{
 
 namespace level{
 
-bool LoadLevelXML(const std::string &filename, photon_instance &instance){
-    photon_level &level = instance.level;
-    photon_player &player = instance.player;
+const char* GetModeName(photon_level::game_mode mode){
+    switch(mode){
+    default:
+    case photon_level::none:
+        return "none";
+    case photon_level::power:
+        return "power";
+    case photon_level::targets:
+        return "targets";
+    case photon_level::destruction:
+        return "destruction";
+    case photon_level::tnt_harvester:
+        return "tnt_harvester";
+    case photon_level::script:
+        return "script";
+    }
+}
+
+photon_level::game_mode GetModeFromName(const char *name){
+    if(name == nullptr){
+        return photon_level::none;
+    }
+    std::string str(name);
+    if(str == "power"){
+        return photon_level::power;
+    }else if(str == "targets"){
+        return photon_level::targets;
+    }else if(str == "destruction"){
+        return photon_level::destruction;
+    }else if(str == "tnt_harvester"){
+        return photon_level::tnt_harvester;
+    }else if(str == "script"){
+        return photon_level::script;
+    }
+    return photon_level::none;
+}
+
+bool LoadLevelXML(const std::string &filename, photon_level &level, photon_player &player){
     if(PHYSFS_exists(filename.c_str())){
         PHYSFS_File *file;
         long length;
@@ -49,7 +83,6 @@ bool LoadLevelXML(const std::string &filename, photon_instance &instance){
 
         level = photon_level();
         lua::Reset();
-        instance.gui.game.message.clear();
 
         xmlChar *width_str = xmlGetProp(root, (const xmlChar*)"width");
         xmlChar *height_str = xmlGetProp(root, (const xmlChar*)"height");
@@ -60,30 +93,21 @@ bool LoadLevelXML(const std::string &filename, photon_instance &instance){
         if(w <= 0 || h <= 0){
             PrintToLog("WARNING: level \"%s\" dimensions are less than 1x1!", filename.c_str());
         }
-        if(w > 250 || h > 250){
-            PrintToLog("WARNING: level \"%s\" dimensions exceed 250x250! capping...", filename.c_str());
+        if(w > PHOTON_LEVEL_MAX_SIZE || h > PHOTON_LEVEL_MAX_SIZE){
+            PrintToLog("WARNING: level \"%s\" dimensions exceed %ix%i! capping...", filename.c_str(), PHOTON_LEVEL_MAX_SIZE, PHOTON_LEVEL_MAX_SIZE);
         }
-        level.width = std::min(std::max(w, 1), 250);
-        level.height = std::min(std::max(h, 1), 250);
+        w = std::min(std::max(w, 1), PHOTON_LEVEL_MAX_SIZE);
+        h = std::min(std::max(h, 1), PHOTON_LEVEL_MAX_SIZE);
 
         xmlFree(width_str);
         xmlFree(height_str);
 
-        PrintToLog("INFO: Level size %i x %i", level.width, level.height);
+        PrintToLog("INFO: Level size %i x %i", w, h);
 
         //because we fill the edges with indestructible blocks.
-        level.width  += 2;
-        level.height += 2;
+        level::ResizeGrid(level, w + 2, h + 2);
 
-        // fill the borders with indestructible blocks.
-        for(int x = 0; x < level.width; x++){
-            level.grid[photon_level_coord(x, 0               )].type = indestructible;
-            level.grid[photon_level_coord(x, level.height - 1)].type = indestructible;
-        }
-        for(int y = 0; y < level.height; y++){
-            level.grid[photon_level_coord(0,               y)].type = indestructible;
-            level.grid[photon_level_coord(level.width - 1, y)].type = indestructible;
-        }
+        level::FillBorder(level);
 
         xmlChar *playerx_str = xmlGetProp(root, (const xmlChar*)"playerx");
         xmlChar *playery_str = xmlGetProp(root, (const xmlChar*)"playery");
@@ -104,7 +128,7 @@ bool LoadLevelXML(const std::string &filename, photon_instance &instance){
                 while(row != nullptr){
                     if((xmlStrEqual(row->name, (const xmlChar*)"row"))){
                         xmlChar *y_str = xmlGetProp(row, (const xmlChar*)"y");
-                        uint8_t y = atoi((char*)y_str);
+                        int64_t y = atoll((char*)y_str);
                         xmlFree(y_str);
 
                         if(y >= level.height || y < 0){
@@ -117,7 +141,7 @@ bool LoadLevelXML(const std::string &filename, photon_instance &instance){
                         while(block_xml != nullptr) {
                             if((xmlStrEqual(block_xml->name, (const xmlChar*)"block"))){
                                 xmlChar *x_str = xmlGetProp(block_xml, (const xmlChar*)"x");
-                                uint8_t x = atoi((char*)x_str);
+                                int64_t x = atoll((char*)x_str);
                                 xmlFree(x_str);
 
                                 if(x >= level.width || x < 0){
@@ -128,26 +152,23 @@ bool LoadLevelXML(const std::string &filename, photon_instance &instance){
 
                                 xmlChar *type_str = xmlGetProp(block_xml, (const xmlChar*)"type");
 
-                                photon_block &block = level.grid[photon_level_coord(x,y)];
+                                photon_block block;
 
                                 block.type = blocks::GetBlockFromName((char*)type_str);
 
-                                if(block.type == mirror || block.type == mirror_locked ||
-                                        block.type == emitter_white || block.type == emitter_red ||
-                                        block.type == emitter_green || block.type == emitter_blue ||
-                                        block.type == receiver_white || block.type == receiver_red ||
-                                        block.type == receiver_green || block.type == receiver_blue ||
-                                        block.type == receiver){
+                                if(blocks::GetTraits(block.type).has_rotation){
 
                                     xmlChar *angle_str = xmlGetProp(block_xml, (const xmlChar*)"angle");
 
                                     if(angle_str != nullptr){
-                                        block.angle = atof((char*)angle_str);
+                                        block.rotation = blocks::DegreesToRotation(atof((char*)angle_str));
 
                                         xmlFree(angle_str);
                                     }
                                 }
 
+                                level::SetBlock(level, glm::uvec2(x, y), block);
+
                                 xmlFree(type_str);
                             }
                             block_xml = block_xml->next;
@@ -185,15 +206,7 @@ bool LoadLevelXML(const std::string &filename, photon_instance &instance){
 
         xmlChar *mode_str = xmlGetProp(root, (const xmlChar*)"mode");
 
-        if(xmlStrEqual(mode_str, (const xmlChar*)"power")){
-            level.mode = photon_level::power;
-        }else if(xmlStrEqual(mode_str, (const xmlChar*)"targets")){
-            level.mode = photon_level::targets;
-        }else if(xmlStrEqual(mode_str, (const xmlChar*)"destruction")){
-            level.mode = photon_level::destruction;
-        }else if(xmlStrEqual(mode_str, (const xmlChar*)"tnt_harvester")){
-            level.mode = photon_level::tnt_harvester;
-        }else if(xmlStrEqual(mode_str, (const xmlChar*)"script")){
+        if(xmlStrEqual(mode_str, (const xmlChar*)"script")){
             xmlChar *script_str = xmlGetProp(root, (const xmlChar*)"script");
 
             if(script_str != nullptr){
@@ -205,7 +218,7 @@ bool LoadLevelXML(const std::string &filename, photon_instance &instance){
                 xmlFree(script_str);
             }
         }else{
-            level.mode = photon_level::none;
+            level.mode = GetModeFromName((char*)mode_str);
         }
 
         xmlFree(mode_str);
@@ -240,6 +253,14 @@ void SaveLevelXML(const std::string &filename, const photon_level &level, const
     xmlSetProp(root, (const xmlChar*)"width",  (const xmlChar*)std::to_string(level.width  - 2).c_str());
     xmlSetProp(root, (const xmlChar*)"height", (const xmlChar*)std::to_string(level.height - 2).c_str());
 
+    // script levels can't be saved with their script yet.
+    if(level.mode != photon_level::none && level.mode != photon_level::script){
+        xmlSetProp(root, (const xmlChar*)"mode", (const xmlChar*)GetModeName(level.mode));
+    }
+    if(level.mode == photon_level::tnt_harvester){
+        xmlSetProp(root, (const xmlChar*)"goal", (const xmlChar*)std::to_string(level.goal).c_str());
+    }
+
     xmlSetProp(root, (const xmlChar*)"playerx", (const xmlChar*)std::to_string(player.location.x).c_str());
     xmlSetProp(root, (const xmlChar*)"playery", (const xmlChar*)std::to_string(player.location.y).c_str());
 
@@ -261,45 +282,61 @@ void SaveLevelXML(const std::string &filename, const photon_level &level, const
     xmlNode *data = xmlNewNode(nullptr, (const xmlChar*)"data");
     xmlAddChild(root, data);
 
-    std::map<uint8_t, xmlNode*> rows;
-
-    for(auto block : level.grid){
-        xmlNode* block_xml = xmlNewNode(nullptr, (const xmlChar*)"block");
-        xmlSetProp(block_xml, (const xmlChar*)"x", (const xmlChar*)std::to_string(block.first.first).c_str());
-
-        switch(block.second.type){
-        case mirror:
-        case mirror_locked:
-        case emitter_white:
-        case emitter_red:
-        case emitter_green:
-        case emitter_blue:
-            xmlSetProp(block_xml, (const xmlChar*)"angle", (const xmlChar*)std::to_string(block.second.angle).c_str());
-        case tnt:
-            // TODO - store TNT warmup.
-            break;
-        case indestructible:
-            if(block.first.first == 0 || block.first.first == level.width - 1 ||
-                    block.first.second == 0 || block.first.second == level.height - 1){
-                // block is a border block, no need to store.
-                xmlFreeNode(block_xml);
-                continue;
-            }
-            break;
-        default:
-            break;
+    std::vector<const photon_level_chunk*> chunks = level::GetSortedChunks(level);
+
+    // chunks are sorted by row, so go through one row of chunks at a time to write the blocks in order.
+    for(auto chunk_row = chunks.begin(); chunk_row != chunks.end();){
+        auto chunk_row_end = chunk_row;
+        while(chunk_row_end != chunks.end() && (*chunk_row_end)->origin.y == (*chunk_row)->origin.y){
+            ++chunk_row_end;
         }
 
-        xmlSetProp(block_xml, (const xmlChar*)"type", (const xmlChar*)blocks::GetBlockName(block.second.type));
-        if(rows.count(block.first.second)){
-            xmlAddChild(rows[block.first.second], block_xml);
-        }else{
-            xmlNode* row_xml = xmlNewNode(nullptr, (const xmlChar*)"row");
-            xmlSetProp(row_xml, (const xmlChar*)"y", (const xmlChar*)std::to_string(block.first.second).c_str());
-            xmlAddChild(data, row_xml);
-            rows[block.first.second] = row_xml;
-            xmlAddChild(row_xml, block_xml);
+        for(uint32_t local_y = 0; local_y < PHOTON_CHUNK_SIZE; local_y++){
+            uint32_t y = (*chunk_row)->origin.y + local_y;
+            xmlNode* row_xml = nullptr;
+
+            for(auto chunk = chunk_row; chunk != chunk_row_end; ++chunk){
+                for(uint32_t local_x = 0; local_x < PHOTON_CHUNK_SIZE; local_x++){
+                    const photon_block &block = (*chunk)->blocks[local_y * PHOTON_CHUNK_SIZE + local_x];
+                    uint32_t x = (*chunk)->origin.x + local_x;
+
+                    if(block.type == air){
+                        continue;
+                    }
+
+                    xmlNode* block_xml = xmlNewNode(nullptr, (const xmlChar*)"block");
+                    xmlSetProp(block_xml, (const xmlChar*)"x", (const xmlChar*)std::to_string(x).c_str());
+
+                    if(blocks::GetTraits(block.type).has_rotation){
+                        xmlSetProp(block_xml, (const xmlChar*)"angle", (const xmlChar*)std::to_string(block.rotation * (360.0f / PHOTON_ROTATION_STEPS)).c_str());
+                    }
+
+                    switch(block.type){
+                    case tnt:
+                        // TODO - store TNT warmup.
+                        break;
+                    case indestructible:
+                        if(x == 0 || x == level.width - 1 || y == 0 || y == level.height - 1){
+                            // block is a border block, no need to store.
+                            xmlFreeNode(block_xml);
+                            continue;
+                        }
+                        break;
+                    default:
+                        break;
+                    }
+
+                    xmlSetProp(block_xml, (const xmlChar*)"type", (const xmlChar*)blocks::GetBlockName(block.type));
+                    if(row_xml == nullptr){
+                        row_xml = xmlNewNode(nullptr, (const xmlChar*)"row");
+                        xmlSetProp(row_xml, (const xmlChar*)"y", (const xmlChar*)std::to_string(y).c_str());
+                        xmlAddChild(data, row_xml);
+                    }
+                    xmlAddChild(row_xml, block_xml);
+                }
+            }
         }
+        chunk_row = chunk_row_end;
     }
 
     // TODO - perhaps store what level originally loaded so people can come back to puzzles and still have it count? that will probably enable cheating though...
@@ -0,0 +1,71 @@
+#include "photon_log.h"
+
+#include <chrono>
+#include <ctime>
+#include <cstdio>
+#include <stdarg.h>
+
+namespace photon{
+FILE* logfile = nullptr;
+
+void OpenLog(const char *filename){
+    CloseLog();
+    logfile = fopen(filename, "w");
+}
+
+void CloseLog(){
+    if(logfile){
+        fclose(logfile);
+        logfile = nullptr;
+    }
+}
+
+#ifdef _MSC_VER
+#define snprintf _snprintf
+#endif
+
+void PrintToLog(const char *format,...){
+    va_list args, args2;
+    va_start(args, format);
+    va_copy(args2, args);
+
+    /* Create the timestamp string */
+    std::chrono::high_resolution_clock::time_point current = std::chrono::high_resolution_clock::now();
+
+    time_t tnow = std::chrono::high_resolution_clock::to_time_t(current);
+    tm *date = std::localtime(&tnow);
+    int microseconds = std::chrono::duration_cast<std::chrono::microseconds>(current.time_since_epoch()).count() % 1000000;
+
+    /* The size of this is constant, so it might as well not be on the heap.
+     * It saves us from some confusing sizing & position calculation by keeping it seperate from the main output string. */
+    char timestamp[18];
+    snprintf(timestamp, 18, "%02i:%02i:%02i.%06i: ", date->tm_hour, date->tm_min, date->tm_sec, microseconds);
+    timestamp[17] = '\0';
+
+    /* Create the main output string */
+    int len = vsnprintf(nullptr, 0, format, args) + 1;
+
+    char* buffer = new char[len + 1];
+
+    vsnprintf(buffer, len, format, args2);
+
+    va_end(args);
+    va_end(args2);
+
+    buffer[len - 1] = '\n';
+    buffer[len] = '\0';
+
+    /* Write the strings to stdout and log file. */
+    fputs(timestamp, stdout);
+    fputs(buffer, stdout);
+    fflush(stdout);
+
+    if(logfile){
+        fputs(timestamp, logfile);
+        fputs(buffer, logfile);
+        fflush(logfile);
+    }
+
+    delete[] buffer;
+}
+}
@@ -1,15 +1,16 @@
-#include "photon_lua.h"
-#include "photon_core.h"
+#include "photon_sim.h"
 
 #include <lua.hpp>
 #include <physfs.h>
 
 namespace photon{
 
-extern photon_instance instance;
-
 namespace lua{
 
+// the level & player the API functions act on, set by InitLua().
+static photon_level *current_level = nullptr;
+static photon_player *current_player = nullptr;
+
 struct timer{
     int lua_call_ref = LUA_NOREF;
     float timeout = INFINITY;
@@ -42,7 +43,7 @@ namespace generic_funcs{
 static int After(lua_State *L){
     if(lua_gettop(L) == 2 && lua_isfunction(L, 1) && lua_isnumber(L, 2)){
         timer t;
-        t.timeout = instance.level.time + lua_tonumber(L, 2);
+        t.timeout = current_level->time + lua_tonumber(L, 2);
         lua_pop(L, 1);
 
         int f = luaL_ref(L, LUA_REGISTRYINDEX);
@@ -71,20 +72,6 @@ static const luaL_Reg funcs[] = {
 
 }
 
-namespace window_funcs{
-
-static int ToggleFullscreen(lua_State *L) {
-    window_managment::ToggleFullscreen(instance.window);
-    return 0;
-}
-
-static const luaL_Reg funcs[] = {
-    {"toggle_fullscreen", ToggleFullscreen},
-    {nullptr, nullptr}
-};
-
-}
-
 namespace level_funcs{
 
 static int LoadLevel(lua_State *L) {
@@ -98,7 +85,7 @@ static int LoadLevel(lua_State *L) {
         file = lua_tostring(L, -1);  /* get result */
         lua_pop(L, 1);  /* pop result */
 
-        level::LoadLevelXML(file, instance);
+        level::LoadLevelXML(file, *current_level, *current_player);
 
         PrintToLog("INFO: Lua loaded level file %s", file.c_str());
     }else{
@@ -118,7 +105,7 @@ static int SaveLevel(lua_State *L) {
         file = lua_tostring(L, -1);  /* get result */
         lua_pop(L, 1);  /* pop result */
 
-        level::SaveLevelXML(file, instance.level, instance.player);
+        level::SaveLevelXML(file, *current_level, *current_player);
 
         PrintToLog("INFO: Lua saved level file %s", file.c_str());
     }else{
@@ -128,7 +115,7 @@ static int SaveLevel(lua_State *L) {
 }
 
 static int CloseLevel(lua_State *L) {
-    instance.level = photon_level();
+    *current_level = photon_level();
     return 0;
 }
 
@@ -137,8 +124,8 @@ static int SetCheckVictory(lua_State *L){
         int f = luaL_ref(L, LUA_REGISTRYINDEX);
 
         if(f != LUA_REFNIL && f != LUA_NOREF){
-            instance.level.mode = photon_level::script;
-            instance.level.lua_checkvictory = f;
+            current_level->mode = photon_level::script;
+            current_level->lua_checkvictory = f;
             PrintToLog("INFO: Lua set victory condition.");
         }else{
             PrintToLog("WARNING: Unable to set lua victory condition!");
@@ -160,19 +147,12 @@ static int GetItemCount(lua_State *L) {
         std::string type_str = lua_tostring(L, -1);  /* get result */
         lua_settop(L, 0);
 
-        int count = 0;
         block_type type = blocks::GetBlockFromName(type_str.c_str());
 
-        for(auto block : instance.level.grid){
-            if(block.second.type == type){
-                count++;
-            }
-        }
-
-        lua_pushinteger(L, count);
+        lua_pushinteger(L, level::GetBlockCount(*current_level, type));
         return 1;
     }else if(n == 0){
-        lua_pushinteger(L, instance.level.grid.size());
+        lua_pushinteger(L, level::GetBlockCount(*current_level));
         return 1;
     }else{
         PrintToLog("LUA WARNING: level.get_item_count() called with the wrong number of arguments! expected 0 or 1 got %i!", n);
@@ -202,10 +182,10 @@ static int GetItemCount(lua_State *L) {
         std::string type = lua_tostring(L, -1);  /* get result */
         lua_pop(L, 1);  /* pop result */
 
-        lua_pushinteger(L, player::GetItemCount(instance.player, blocks::GetBlockFromName(type.c_str())));
+        lua_pushinteger(L, player::GetItemCount(*current_player, blocks::GetBlockFromName(type.c_str())));
         return 1;
     }else if(n == 0){
-        lua_pushinteger(L, player::GetItemCountCurrent(instance.player));
+        lua_pushinteger(L, player::GetItemCountCurrent(*current_player));
         return 1;
     }else{
         PrintToLog("LUA WARNING: player.get_item_count() called with the wrong number of arguments! expected 0 or 1 got %i!", n);
@@ -216,8 +196,8 @@ static int GetItemCount(lua_State *L) {
 static int SetLocation(lua_State *L) {
     int n = lua_gettop(L);  /* number of arguments */
     if(n == 2){
-        instance.player.location.x = lua_tonumber(L, 1);
-        instance.player.location.y = lua_tonumber(L, 2);
+        current_player->location.x = lua_tonumber(L, 1);
+        current_player->location.y = lua_tonumber(L, 2);
         return 0;
     }else{
         PrintToLog("LUA WARNING: player.set_location() called with the wrong number of arguments! expected 2 got %i!", n);
@@ -229,10 +209,10 @@ static int SnapToBeam(lua_State *L){
     int n = lua_gettop(L);
     if(n == 1){
         // 1 argument = set snap to beam.
-        instance.player.snap_to_beam = lua_toboolean(L, -1);
+        current_player->snap_to_beam = lua_toboolean(L, -1);
     }else if(n == 0){
         // no arguments = get snap to beam.
-        lua_pushboolean(L, instance.player.snap_to_beam);
+        lua_pushboolean(L, current_player->snap_to_beam);
         return 1;
     }else{
         PrintToLog("LUA WARNING: player.snap_to_beam() called with the wrong number of arguments! expected 0 or 1 got %i!", n);
@@ -254,18 +234,18 @@ static int SetMessage(lua_State *L) {
     int n = lua_gettop(L);  /* number of arguments */
     if(n == 1 || n == 2){
         if(n == 2){
-            instance.gui.game.message_timeout = instance.level.time + lua_tonumber(lua, 2);
+            current_level->message_timeout = current_level->time + lua_tonumber(lua, 2);
         }else{
-            instance.gui.game.message_timeout = INFINITY;
+            current_level->message_timeout = INFINITY;
         }
         lua_getglobal(L, "tostring");
         lua_pushvalue(L, -1);  /* function to be called */
         lua_pushvalue(L, 1);   /* value to print */
         lua_call(L, 1, 1);
-        instance.gui.game.message = lua_tostring(L, -1);  /* get result */
+        current_level->message = lua_tostring(L, -1);  /* get result */
         lua_pop(L, 1);  /* pop result */
 
-        PrintToLog("INFO: Lua set message to \"%s\"", instance.gui.game.message.c_str());
+        PrintToLog("INFO: Lua set message to \"%s\"", current_level->message.c_str());
     }else{
         PrintToLog("LUA WARNING: set_message() called with the wrong number of arguments! expected 1 or 2 got %i!", n);
     }
@@ -309,7 +289,10 @@ const luaL_Reg funcs[] = {
 
 #define PHOTON_API_ENTRY(F, N) luaL_newlib(lua, N::funcs); lua_setfield(lua, 1, F); lua_settop(lua, 1)
 
-void InitLua(const std::string &initscript){
+void InitLua(photon_level &level, photon_player &player){
+    current_level = &level;
+    current_player = &player;
+
     PrintToLog("INFO: Initializing Lua.");
     lua = luaL_newstate();
 
@@ -326,7 +309,6 @@ void InitLua(const std::string &initscript){
 
     lua_newtable(lua);
 
-    PHOTON_API_ENTRY("window", window_funcs);
     PHOTON_API_ENTRY("level", level_funcs);
     PHOTON_API_ENTRY("player", player_funcs);
     PHOTON_API_ENTRY("gui", gui_funcs);
@@ -335,14 +317,22 @@ void InitLua(const std::string &initscript){
     luaL_setfuncs(lua, generic_funcs::funcs, 0);
 
     lua_setglobal(lua, "photon");
+}
 
-    DoFile(initscript);
+void RegisterAPI(const char *name, const luaL_Reg *funcs){
+    lua_getglobal(lua, "photon");
+    // luaL_newlib() needs an array to size the table, funcs is only a pointer.
+    lua_newtable(lua);
+    luaL_setfuncs(lua, funcs, 0);
+    lua_setfield(lua, -2, name);
+    lua_pop(lua, 1);
 }
 
 void AdvanceFrame(){
+    PHOTON_PROFILE_ZONE("lua::AdvanceFrame");
     for(auto i = timers.begin(); i != timers.end();){
         timer &t = *i;
-        if(t.timeout < instance.level.time && t.lua_call_ref != LUA_NOREF && t.lua_call_ref != LUA_REFNIL){
+        if(t.timeout < current_level->time && t.lua_call_ref != LUA_NOREF && t.lua_call_ref != LUA_REFNIL){
             lua_rawgeti(lua, LUA_REGISTRYINDEX, t.lua_call_ref);
             if(!lua_isfunction(lua, -1) || lua_pcall(lua, 0, -1, 0) != 0){
                 PrintToLog("WARNING: calling timer function failed!");
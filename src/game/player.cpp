@@ -1,4 +1,4 @@
-#include "photon_core.h"
+#include "photon_sim.h"
 
 #include <glm/gtx/norm.hpp>
 
@@ -6,7 +6,7 @@ namespace photon{
 
 namespace player{
 
-glm::vec2 PointOnSegment(photon_lasersegment &segment, glm::vec2 location){
+glm::vec2 PointOnSegment(const photon_lasersegment &segment, glm::vec2 location){
     glm::vec2 start(segment.start);
     glm::vec2 end(segment.end);
 
@@ -60,6 +60,82 @@ glm::vec2 SnapToBeams(std::vector<photon_laserbeam> &beams, glm::vec2 location){
     return loc;
 }
 
+glm::vec2 SnapToBeams(const photon_level &level, photon_player &player){
+    glm::vec2 location = player.location;
+    if(level.beam_index.empty() || level.width == 0 || level.height == 0){
+        player.last_snap = {UINT32_MAX, UINT32_MAX};
+        return location;
+    }
+    // nothing further than this gets snapped to.
+    float dist = player.snap_distance;
+    glm::vec2 loc = location;
+    photon_segment_ref best = {UINT32_MAX, UINT32_MAX};
+
+    auto check = [&](photon_segment_ref ref){
+        glm::vec2 point = PointOnSegment(level.beams[ref.beam].segments[ref.segment], location);
+        float tdist = glm::distance(point, location);
+        // ties go to the first segment, like looping over all of them would.
+        if(tdist < dist || (tdist == dist && (ref.beam < best.beam || (ref.beam == best.beam && ref.segment < best.segment)))){
+            dist = tdist;
+            loc = point;
+            best = ref;
+        }
+    };
+
+    // the player usually stays on the same segment from frame to frame.
+    photon_segment_ref last = player.last_snap;
+    if(last.beam < level.beams.size() && last.segment < level.beams[last.beam].segments.size()){
+        check(last);
+        if(dist == 0.0f){
+            return loc;
+        }
+    }
+
+    glm::ivec2 cell = glm::ivec2(glm::floor(location / float(PHOTON_CHUNK_SIZE)));
+    glm::ivec2 last_cell = glm::ivec2((level.width - 1) >> PHOTON_CHUNK_SHIFT, (level.height - 1) >> PHOTON_CHUNK_SHIFT);
+
+    // distance from location to the edge of its own chunk.
+    glm::vec2 offset = location - glm::vec2(cell * PHOTON_CHUNK_SIZE);
+    float edge = std::min(std::min(offset.x, float(PHOTON_CHUNK_SIZE) - offset.x), std::min(offset.y, float(PHOTON_CHUNK_SIZE) - offset.y));
+
+    // rings of chunks further out than this are all outside the level.
+    int max_ring = std::max(std::max(std::abs(cell.x), std::abs(cell.x - last_cell.x)), std::max(std::abs(cell.y), std::abs(cell.y - last_cell.y)));
+    // or too far away to snap to. (see the check at the start of each ring below)
+    if(dist < INFINITY){
+        max_ring = std::min(max_ring, int((dist - edge + 1.5f) / PHOTON_CHUNK_SIZE) + 1);
+    }
+
+    for(int ring = 0; ring <= max_ring; ring++){
+        // segments are only indexed by the blocks they cover after their start, so the closest
+        // point of a segment in this ring can be up to a block diagonal (~1.42) closer than its blocks.
+        if(ring > 0 && dist < (ring - 1) * PHOTON_CHUNK_SIZE + edge - 1.5f){
+            break;
+        }
+        for(int y = cell.y - ring; y <= cell.y + ring; y++){
+            if(y < 0 || y > last_cell.y){
+                continue;
+            }
+            // only the first & last rows of the ring need every chunk.
+            int step = (y == cell.y - ring || y == cell.y + ring) ? 1 : std::max(ring * 2, 1);
+            for(int x = cell.x - ring; x <= cell.x + ring; x += step){
+                if(x < 0 || x > last_cell.x){
+                    continue;
+                }
+                auto segments = level.beam_index.find(level::ChunkKey(glm::uvec2(x, y) * uint32_t(PHOTON_CHUNK_SIZE)));
+                if(segments != level.beam_index.end()){
+                    for(photon_segment_ref ref : segments->second){
+                        check(ref);
+                    }
+                }
+            }
+        }
+    }
+
+    player.last_snap = best;
+
+    return loc;
+}
+
 int8_t AddItem(photon_player &player, block_type type, int8_t amount){
     // if it exists and is <= 0 it is infinite
     if(player.items.count(type) && player.items[type] <= 0){
@@ -0,0 +1,143 @@
+#include "photon_sim.h"
+
+#include <physfs.h>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <cstdio>
+#include <cstdarg>
+
+// zones kept per thread before the oldest get overwritten.
+#define PHOTON_PROFILER_EVENTS (1 << 16)
+
+namespace photon{
+
+struct photon_profiler_event{
+    const char *name;
+    int64_t start;
+    int64_t end;
+};
+
+// only written by its own thread, head is atomic so it can be read while the thread is running.
+struct photon_profiler_buffer{
+    std::vector<photon_profiler_event> events = std::vector<photon_profiler_event>(PHOTON_PROFILER_EVENTS);
+    std::atomic<uint64_t> head{0};
+
+    uint32_t thread_id = 0;
+    std::string thread_name;
+};
+
+namespace profiler{
+
+std::atomic<bool> enabled{true};
+
+static const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
+// buffers are never freed, so threads that stopped still show up in the trace.
+static std::mutex buffers_mutex;
+static std::vector<std::unique_ptr<photon_profiler_buffer>> buffers;
+
+static thread_local photon_profiler_buffer *thread_buffer = nullptr;
+
+photon_profiler_buffer &GetThreadBuffer(){
+    if(thread_buffer == nullptr){
+        std::lock_guard<std::mutex> lock(buffers_mutex);
+        buffers.emplace_back(new photon_profiler_buffer());
+        thread_buffer = buffers.back().get();
+        thread_buffer->thread_id = buffers.size() - 1;
+        thread_buffer->thread_name = "thread " + std::to_string(thread_buffer->thread_id);
+    }
+    return *thread_buffer;
+}
+
+int64_t Now(){
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_time).count();
+}
+
+void Record(const char *name, int64_t start, int64_t end){
+    photon_profiler_buffer &buffer = GetThreadBuffer();
+    uint64_t head = buffer.head.load(std::memory_order_relaxed);
+
+    photon_profiler_event &event = buffer.events[head % PHOTON_PROFILER_EVENTS];
+    event.name = name;
+    event.start = start;
+    event.end = end;
+
+    buffer.head.store(head + 1, std::memory_order_release);
+}
+
+void SetEnabled(bool enable){
+    enabled.store(enable, std::memory_order_relaxed);
+}
+
+void SetThreadName(const char *name){
+    photon_profiler_buffer &buffer = GetThreadBuffer();
+    std::lock_guard<std::mutex> lock(buffers_mutex);
+    buffer.thread_name = name;
+}
+
+// appends printf style formatted text to out.
+void Append(std::string &out, const char *format, ...){
+    char buffer[512];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    if(length > 0){
+        out.append(buffer, std::min(size_t(length), sizeof(buffer) - 1));
+    }
+}
+
+bool WriteChromeTrace(const std::string &filename){
+    std::string out;
+
+    std::unique_lock<std::mutex> lock(buffers_mutex);
+
+    uint64_t total = 0;
+    const char *separator = "";
+
+    Append(out, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+    for(const auto &buffer : buffers){
+        Append(out, "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %u, \"args\": {\"name\": \"%s\"}}",
+               separator, buffer->thread_id, buffer->thread_name.c_str());
+        separator = ",\n";
+
+        uint64_t head = buffer->head.load(std::memory_order_acquire);
+        uint64_t first = head > PHOTON_PROFILER_EVENTS ? head - PHOTON_PROFILER_EVENTS : 0;
+
+        for(uint64_t i = first; i < head; i++){
+            const photon_profiler_event &event = buffer->events[i % PHOTON_PROFILER_EVENTS];
+            // trace_event times are in microseconds.
+            Append(out, "%s{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %u, \"ts\": %.3f, \"dur\": %.3f}",
+                   separator, event.name, buffer->thread_id, event.start * 1.0e-3, (event.end - event.start) * 1.0e-3);
+        }
+        total += head - first;
+    }
+    Append(out, "\n]}\n");
+
+    lock.unlock();
+
+    // like saved levels, the trace goes in the PhysFS write directory.
+    PHYSFS_File *file = PHYSFS_openWrite(filename.c_str());
+    if(file == nullptr){
+        PrintToLog("ERROR: unable to open \"%s\" to write profiler trace! %s", filename.c_str(), PHYSFS_getLastError());
+        return false;
+    }
+    PHYSFS_sint64 written = PHYSFS_write(file, out.data(), 1, out.size());
+    PHYSFS_close(file);
+
+    if(written != PHYSFS_sint64(out.size())){
+        PrintToLog("ERROR: unable to write profiler trace to \"%s\"! %s", filename.c_str(), PHYSFS_getLastError());
+        return false;
+    }
+
+    PrintToLog("INFO: wrote %llu profiler zones to \"%s\".", (unsigned long long)total, filename.c_str());
+
+    return true;
+}
+
+}
+
+}
@@ -0,0 +1,70 @@
+#include "photon_sim.h"
+
+namespace photon{
+
+namespace stats{
+
+uint32_t GetBucket(uint64_t value){
+    if(value < PHOTON_HISTOGRAM_SUB_BUCKETS){
+        return value;
+    }
+    uint32_t msb = 0;
+    while((value >> (msb + 1)) != 0){
+        msb++;
+    }
+    uint32_t shift = msb - PHOTON_HISTOGRAM_SUB_BITS;
+    uint32_t bucket = ((shift + 1) << PHOTON_HISTOGRAM_SUB_BITS) | ((value >> shift) & (PHOTON_HISTOGRAM_SUB_BUCKETS - 1));
+
+    return std::min(bucket, uint32_t(PHOTON_HISTOGRAM_BUCKETS - 1));
+}
+
+// the smallest value that goes in bucket.
+uint64_t GetBucketStart(uint32_t bucket){
+    if(bucket < PHOTON_HISTOGRAM_SUB_BUCKETS){
+        return bucket;
+    }
+    uint32_t shift = (bucket >> PHOTON_HISTOGRAM_SUB_BITS) - 1;
+    return uint64_t(PHOTON_HISTOGRAM_SUB_BUCKETS + (bucket & (PHOTON_HISTOGRAM_SUB_BUCKETS - 1))) << shift;
+}
+
+void Record(photon_histogram &histogram, uint64_t value){
+    histogram.counts[GetBucket(value)]++;
+    histogram.count++;
+    histogram.max = std::max(histogram.max, value);
+
+    if(histogram.budget > 0 && value > histogram.budget){
+        histogram.over_budget++;
+    }
+}
+
+uint64_t GetPercentile(const photon_histogram &histogram, double percentile){
+    if(histogram.count == 0){
+        return 0;
+    }
+    uint64_t target = std::max<uint64_t>(uint64_t(std::ceil(histogram.count * glm::clamp(percentile, 0.0, 100.0) * 0.01)), 1);
+    uint64_t total = 0;
+
+    for(uint32_t bucket = 0; bucket < PHOTON_HISTOGRAM_BUCKETS; bucket++){
+        total += histogram.counts[bucket];
+        if(total >= target){
+            return std::min(GetBucketStart(bucket + 1) - 1, histogram.max);
+        }
+    }
+    return histogram.max;
+}
+
+void Reset(photon_histogram &histogram){
+    uint64_t budget = histogram.budget;
+    histogram = photon_histogram();
+    histogram.budget = budget;
+}
+
+void PrintReport(const char *name, const photon_histogram &histogram){
+    PrintToLog("INFO: %s: %llu frames, p50 %.2fms p90 %.2fms p99 %.2fms max %.2fms, %llu over the %.2fms budget.", name,
+               (unsigned long long)histogram.count, GetPercentile(histogram, 50.0) * 1.0e-3, GetPercentile(histogram, 90.0) * 1.0e-3,
+               GetPercentile(histogram, 99.0) * 1.0e-3, histogram.max * 1.0e-3, (unsigned long long)histogram.over_budget, histogram.budget * 1.0e-3);
+}
+
+}
+
+}
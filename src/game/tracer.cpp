@@ -1,61 +1,325 @@
-#include "photon_level.h"
+#include "photon_sim.h"
 
-#include <glm/gtx/rotate_vector.hpp>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
 
 namespace photon{
 
 namespace tracer{
 
-void TraceBeam(photon_laserbeam& beam, photon_level &level, float time){
+static const int8_t direction_steps[PHOTON_DIRECTIONS][2] = {
+    { 1, 0}, { 1, 1}, { 0, 1}, {-1, 1},
+    {-1, 0}, {-1,-1}, { 0,-1}, { 1,-1}
+};
+
+struct photon_tracer_threads{
+    std::vector<std::thread> threads;
+
+    std::mutex mutex;
+    std::condition_variable start;
+    std::condition_variable done;
+
+    // the current job, beams are handed out one at a time through next.
+    const std::vector<photon_laserbeam*> *beams = nullptr;
+    const photon_level *level = nullptr;
+    // interactions left for all the job's beams together, nullptr for no limit.
+    std::atomic<int64_t> *budget = nullptr;
+    std::atomic<size_t> next;
+
+    // (location, direction) of every segment start in the beam being traced, one set per thread. (the calling thread is 0)
+    std::vector<std::unordered_set<uint64_t>> visited;
+
+    // incremented for every job so the threads know when there is a new one.
+    uint64_t job = 0;
+    size_t busy = 0;
+    bool quit = false;
+};
+
+static photon_tracer_threads tracer_threads;
+
+static uint32_t trace_budget = 1 << 20;
+
+void SetTraceBudget(uint32_t steps){
+    trace_budget = steps;
+}
+
+uint32_t GetTraceBudget(){
+    return trace_budget;
+}
+
+inline uint64_t VisitedKey(const photon_lasersegment &segment){
+    return (uint64_t(segment.start.y) << 35) | (uint64_t(segment.start.x) << 3) | segment.direction;
+}
+
+glm::ivec2 GetDirectionStep(uint8_t direction){
+    return glm::ivec2(direction_steps[direction][0], direction_steps[direction][1]);
+}
+
+// adds the chunks of the blocks after start up to & including end to beam.chunks.
+void AddChunks(photon_laserbeam& beam, uint32_t segment, glm::uvec2 start, glm::uvec2 end, glm::ivec2 direction){
+    glm::ivec2 location(start);
+    uint32_t remaining = std::max(std::abs(int32_t(end.x - start.x)), std::abs(int32_t(end.y - start.y)));
+
+    while(remaining > 0){
+        location += direction;
+        remaining--;
+
+        uint64_t chunk = level::ChunkKey(glm::uvec2(location));
+        if(beam.chunks.empty() || beam.chunks.back().key != chunk || beam.chunks.back().segment != segment){
+            beam.chunks.push_back({chunk, segment});
+        }
+
+        // the rest of the blocks up to the edge of this chunk are in the same chunk.
+        uint32_t skip = remaining;
+        if(direction.x > 0){
+            skip = std::min(skip, uint32_t(PHOTON_CHUNK_MASK - (location.x & PHOTON_CHUNK_MASK)));
+        }else if(direction.x < 0){
+            skip = std::min(skip, uint32_t(location.x & PHOTON_CHUNK_MASK));
+        }
+        if(direction.y > 0){
+            skip = std::min(skip, uint32_t(PHOTON_CHUNK_MASK - (location.y & PHOTON_CHUNK_MASK)));
+        }else if(direction.y < 0){
+            skip = std::min(skip, uint32_t(location.y & PHOTON_CHUNK_MASK));
+        }
+        location += direction * int32_t(skip);
+        remaining -= skip;
+    }
+}
+
+// every interaction takes one from budget, the beam is truncated once it runs out. (nullptr for no limit)
+void TraceBeam(photon_laserbeam& beam, const photon_level &level, std::atomic<int64_t> *budget, std::unordered_set<uint64_t> &visited){
     photon_lasersegment *segment;
 
     // delete old data.
     beam.segments.clear();
+    beam.hits.clear();
+    beam.chunks.clear();
 
-    beam.segments.push_back(photon_lasersegment(beam));
+    beam.segments.push_back(photon_lasersegment());
 
     segment = &beam.segments.back();
 
     segment->color = beam.color;
     segment->start = beam.origin;
-    segment->angle = beam.origin_angle;
+    segment->end = beam.origin;
+    segment->direction = beam.origin_direction;
 
     glm::uvec2 last_trace_location = segment->start;
 
+    beam.steps = 0;
+    beam.closed_loop = false;
+    beam.truncated = false;
+
     while(segment != nullptr){
-        glm::vec2 trace = glm::rotate(glm::vec2(1.0f, 0.0f), glm::radians(segment->angle));
+        if(budget != nullptr && budget->fetch_sub(1) <= 0){
+            beam.truncated = true;
+            break;
+        }
+
+        glm::ivec2 direction = GetDirectionStep(segment->direction);
 
-        // laser should always be at angle that is a multiple of 45, so rounding the coordinates to 1 will keep it as such.
-        trace = glm::round(trace);
+        // skip straight to the next block, if there isn't one the laser goes to the edge of the level.
+        glm::uvec2 trace_location;
+        bool hit = level::FindNextBlock(level, last_trace_location, direction, trace_location);
 
-        glm::uvec2 trace_location = last_trace_location + glm::uvec2(trace);
+        AddChunks(beam, segment - beam.segments.data(), last_trace_location, trace_location, direction);
 
-        // check to se if the laser is within the bounds of the level.
-        if(trace_location.x >= level.width || trace_location.y >= level.height){
-            segment = nullptr;
+        segment->end = trace_location;
+
+        if(!hit){
             break;
         }
 
-        segment->end = trace_location;
+        size_t segment_count = beam.segments.size();
+        segment = blocks::OnLightInteract(beam, segment, trace_location, level);
+        beam.steps++;
 
-        segment = blocks::OnLightInteract(segment, trace_location, level, time);
+        // a new segment starting somewhere the beam has already started one going the same way means it is going around in a loop.
+        if(segment != nullptr && beam.segments.size() != segment_count && !visited.insert(VisitedKey(*segment)).second){
+            beam.closed_loop = true;
+            break;
+        }
 
         last_trace_location = trace_location;
     }
+
+    // only clear what this beam added, so the cost doesn't depend on the size of the set.
+    for(size_t i = 1; i < beam.segments.size(); i++){
+        visited.erase(VisitedKey(beam.segments[i]));
+    }
+
+    // segments that stopped before covering any blocks still need to be found by player::SnapToBeams().
+    for(size_t i = 0; i < beam.segments.size(); i++){
+        if(beam.segments[i].start == beam.segments[i].end){
+            beam.chunks.push_back({level::ChunkKey(beam.segments[i].start), uint32_t(i)});
+        }
+    }
+
+    // mirrors can send the beam back through a chunk it already went through.
+    std::sort(beam.chunks.begin(), beam.chunks.end(), [](const photon_laserchunk &a, const photon_laserchunk &b){
+        return a.key < b.key || (a.key == b.key && a.segment < b.segment);
+    });
+    beam.chunks.erase(std::unique(beam.chunks.begin(), beam.chunks.end(), [](const photon_laserchunk &a, const photon_laserchunk &b){
+        return a.key == b.key && a.segment == b.segment;
+    }), beam.chunks.end());
+
+    beam.dirty = false;
+}
+
+void TraceBeam(photon_laserbeam& beam, const photon_level &level, uint32_t max_steps){
+    std::unordered_set<uint64_t> visited;
+    std::atomic<int64_t> budget(max_steps);
+    TraceBeam(beam, level, max_steps != 0 ? &budget : nullptr, visited);
 }
 
-photon_lasersegment *CreateChildBeam(photon_lasersegment *parent){
-    parent->beam.segments.push_back(photon_lasersegment(parent->beam));
+void TraceJob(size_t thread){
+    PHOTON_PROFILE_ZONE("tracer::TraceJob");
+    size_t i;
+    while((i = tracer_threads.next++) < tracer_threads.beams->size()){
+        TraceBeam(*(*tracer_threads.beams)[i], *tracer_threads.level, tracer_threads.budget, tracer_threads.visited[thread]);
+    }
+}
 
-    parent->child = &parent->beam.segments.back();
-    parent->child->parent = parent;
+// job is the last job handed out before the thread was started, so it only wakes up for new ones.
+void TraceThread(size_t thread, uint64_t job){
+    profiler::SetThreadName(("tracer " + std::to_string(thread)).c_str());
+    std::unique_lock<std::mutex> lock(tracer_threads.mutex);
+
+    while(true){
+        tracer_threads.start.wait(lock, [&job]{ return tracer_threads.quit || tracer_threads.job != job; });
+        if(tracer_threads.quit){
+            return;
+        }
+        job = tracer_threads.job;
+
+        lock.unlock();
+        TraceJob(thread);
+        lock.lock();
+
+        if(--tracer_threads.busy == 0){
+            tracer_threads.done.notify_one();
+        }
+    }
+}
+
+void TraceBeams(const std::vector<photon_laserbeam*> &beams, const photon_level &level, uint32_t budget){
+    PHOTON_PROFILE_ZONE("tracer::TraceBeams");
+    if(tracer_threads.visited.empty()){
+        tracer_threads.visited.resize(1);
+    }
+
+    std::atomic<int64_t> remaining(budget);
+    std::atomic<int64_t> *shared_budget = budget != 0 ? &remaining : nullptr;
+
+    // beams only write to themselves while tracing, so the order they get traced in doesn't change the result.
+    // (unless the budget runs out, then which beams get cut short depends on which threads get to it first)
+    if(tracer_threads.threads.empty() || beams.size() < 2){
+        for(photon_laserbeam *beam : beams){
+            TraceBeam(*beam, level, shared_budget, tracer_threads.visited[0]);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(tracer_threads.mutex);
+        tracer_threads.beams = &beams;
+        tracer_threads.level = &level;
+        tracer_threads.budget = shared_budget;
+        tracer_threads.next = 0;
+        tracer_threads.busy = tracer_threads.threads.size();
+        tracer_threads.job++;
+    }
+    tracer_threads.start.notify_all();
+
+    // this thread helps out instead of just waiting.
+    TraceJob(0);
+
+    std::unique_lock<std::mutex> lock(tracer_threads.mutex);
+    tracer_threads.done.wait(lock, []{ return tracer_threads.busy == 0; });
+}
+
+void InitThreads(int count){
+    GarbageCollect();
+
+    if(count <= 0){
+        count = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    PrintToLog("INFO: Tracing beams on %i thread(s).", count);
+
+    std::lock_guard<std::mutex> lock(tracer_threads.mutex);
+    tracer_threads.quit = false;
+    tracer_threads.visited.resize(count);
+    for(int i = 1; i < count; i++){
+        tracer_threads.threads.push_back(std::thread(TraceThread, i, tracer_threads.job));
+    }
+}
+
+void GarbageCollect(){
+    {
+        std::lock_guard<std::mutex> lock(tracer_threads.mutex);
+        tracer_threads.quit = true;
+
+        // these point into the last TraceBeams() call, which has returned by now.
+        tracer_threads.beams = nullptr;
+        tracer_threads.level = nullptr;
+        tracer_threads.budget = nullptr;
+    }
+    tracer_threads.start.notify_all();
+
+    for(std::thread &thread : tracer_threads.threads){
+        thread.join();
+    }
+    tracer_threads.threads.clear();
+}
+
+void ApplyBeam(photon_laserbeam& beam, photon_level &level, float time){
+    for(const photon_laserhit &hit : beam.hits){
+        blocks::OnLightHit(hit, level, time);
+    }
+}
+
+bool PassesThrough(const photon_laserbeam& beam, glm::uvec2 location){
+    for(const photon_lasersegment &segment : beam.segments){
+        if(PassesThrough(segment, location)){
+            return true;
+        }
+    }
+    return false;
+}
+
+bool PassesThrough(const photon_lasersegment& segment, glm::uvec2 location){
+    glm::ivec2 delta = glm::ivec2(segment.end) - glm::ivec2(segment.start);
+    glm::ivec2 offset = glm::ivec2(location) - glm::ivec2(segment.start);
+
+    int length = std::max(std::abs(delta.x), std::abs(delta.y));
+    int distance = std::max(std::abs(offset.x), std::abs(offset.y));
+
+    // segments only cover the blocks after their start, the start belongs to the parent segment. (or the emitter)
+    if(length == 0 || distance < 1 || distance > length){
+        return false;
+    }
+    return offset == (delta / length) * distance;
+}
+
+photon_lasersegment *CreateChildBeam(photon_laserbeam &beam, photon_lasersegment *parent){
+    photon_lasersegment child;
+    child.parent = parent - beam.segments.data();
 
     // By default the beam inherits these values.
-    parent->child->angle = parent->angle;
-    parent->child->color = parent->color;
-    parent->child->start = parent->end;
+    child.direction = parent->direction;
+    child.color = parent->color;
+    child.start = parent->end;
+    child.end = parent->end;
+
+    // parent is no longer valid after this.
+    beam.segments.push_back(child);
+    beam.segments[child.parent].child = beam.segments.size() - 1;
 
-    return parent->child;
+    return &beam.segments.back();
 }
 
 }
@@ -43,7 +43,7 @@ photon_gui_container InitGUI(){
 
     gui.main_menu.buttons.push_back({"Play",
                                      [](photon_instance &instance) {
-                                         level::LoadLevelXML("/level.xml", instance);
+                                         level::LoadLevelXML("/level.xml", instance.level, instance.player);
                                          instance.paused = false;
                                      } });
     gui.main_menu.buttons.push_back({"Load", StartLoadingGUI });
@@ -55,11 +55,11 @@ photon_gui_container InitGUI(){
     return gui;
 }
 
-void DrawBounds(const photon_gui_bounds &bounds){
-    static const float uv[] = {0.0f, 1.0f,
-                               0.0f, 0.0f,
-                               1.0f, 0.0f,
-                               1.0f, 1.0f};
+void DrawBounds(const photon_gui_bounds &bounds, const glm::vec4 &uv_rect){
+    float uv[] = {uv_rect.x, uv_rect.w,
+                  uv_rect.x, uv_rect.y,
+                  uv_rect.z, uv_rect.y,
+                  uv_rect.z, uv_rect.w};
 
     float verts[] = {bounds.left, bounds.bottom,
                      bounds.left, bounds.top,
@@ -99,7 +99,7 @@ void DrawGUI(photon_instance &instance){
         GLuint tex = blocks::GetBlockTexture(player::CurrentItem(instance.player));
         if(tex){
             glBindTexture(GL_TEXTURE_2D, tex);
-            DrawBounds(gui.current_item);
+            DrawBounds(gui.current_item, blocks::GetBlockUV(player::CurrentItem(instance.player)));
 
             int8_t count = player::GetItemCountCurrent(instance.player);
             if(count < 0){
@@ -111,9 +111,9 @@ void DrawGUI(photon_instance &instance){
         gui::RenderText(gui.moves_display_location, instance.gui.small_font, instance.gui.base_color, false, "Moves: %i", instance.level.moves);
         gui::RenderText(gui.time_display_location,  instance.gui.small_font, instance.gui.base_color, false, "Time: %i:%02i", int(instance.level.time) / 60, int(instance.level.time) % 60);
 
-        if(!gui.message.empty()){
-            if(gui.message_timeout - instance.level.time > 0.0f){
-                float strength = std::min(gui.message_timeout - instance.level.time, 1.0f);
+        if(!instance.level.message.empty()){
+            if(instance.level.message_timeout - instance.level.time > 0.0f){
+                float strength = std::min(instance.level.message_timeout - instance.level.time, 1.0f);
                 glm::vec4 color = instance.gui.background_color;
                 color.a += strength - 1.0f;
                 // TODO - use a texture for this...
@@ -123,9 +123,9 @@ void DrawGUI(photon_instance &instance){
 
                 color = instance.gui.base_color;
                 color.a += strength - 2.0f;
-                RenderText(glm::vec2(gui.message_area.left + 0.04f, gui.message_area.top - instance.gui.small_font.y - 0.04f), instance.gui.small_font, color, false, gui.message);
+                RenderText(glm::vec2(gui.message_area.left + 0.04f, gui.message_area.top - instance.gui.small_font.y - 0.04f), instance.gui.small_font, color, false, instance.level.message);
             }else{
-                gui.message.clear();
+                instance.level.message.clear();
             }
         }
 
@@ -252,7 +252,7 @@ bool HandleMouseClick(photon_instance &instance, int x, int y){
 void ConfirmLoadSave(photon_instance &instance){
     if(instance.gui.load_save_menu.loading && !instance.gui.load_save_menu.saving){
         // TODO - make a popup box with an unable to load message if it failed.
-        level::LoadLevelXML(instance.gui.load_save_menu.filename, instance);
+        level::LoadLevelXML(instance.gui.load_save_menu.filename, instance.level, instance.player);
     }else if(instance.gui.load_save_menu.saving && !instance.gui.load_save_menu.loading){
         // TODO - some GUI feedback of whether or not it actually saved.
         level::SaveLevelXML(instance.gui.load_save_menu.filename, instance.level, instance.player);
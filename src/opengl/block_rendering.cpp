@@ -1,250 +1,265 @@
 #include "photon_texture.h"
 #include "photon_core.h"
 
-GLuint texture_plain_block;
-GLuint texture_indestructible_block;
-GLuint texture_mirror;
-GLuint texture_tnt;
-GLuint texture_explosion;
-GLuint texture_filter_red;
-GLuint texture_filter_green;
-GLuint texture_filter_blue;
-GLuint texture_filter_yellow;
-GLuint texture_filter_cyan;
-GLuint texture_filter_magenta;
-GLuint texture_emitter;
-GLuint texture_receiver;
-GLuint texture_receiver_fx;
-GLuint texture_receiver_fx_red;
-GLuint texture_receiver_fx_green;
-GLuint texture_receiver_fx_blue;
-GLuint texture_target;
+#include <cstddef>
 
 namespace photon{
 
 namespace blocks{
 
-void DrawBlock(glm::vec2 location, float size = 0.5f, float rotation = 0.0f){
-    static const float verts[] = { 1.0f, 1.0f,
-                                   1.0f,-1.0f,
-                                  -1.0f,-1.0f,
-                                  -1.0f, 1.0f};
+// all the block textures packed together, so the whole level draws without switching textures.
+static GLuint atlas = 0;
+// where each block_texture is in the atlas: left, top, right, bottom.
+static glm::vec4 uv_rects[block_texture_count] = {};
 
-    static const float uv[] = {1.0f, 0.0f,
-                               1.0f, 1.0f,
-                               0.0f, 1.0f,
-                               0.0f, 0.0f};
+static const char *texture_files[block_texture_count] = {
+    nullptr,
+    "/textures/blocks/block.png",
+    "/textures/blocks/indestructible_block.png",
+    "/textures/blocks/mirror.png",
+    "/textures/blocks/tnt.png",
+    "/textures/explosion.png",
+    "/textures/blocks/filter_red.png",
+    "/textures/blocks/filter_green.png",
+    "/textures/blocks/filter_blue.png",
+    "/textures/blocks/filter_yellow.png",
+    "/textures/blocks/filter_cyan.png",
+    "/textures/blocks/filter_magenta.png",
+    "/textures/blocks/emitter.png",
+    "/textures/blocks/receiver.png",
+    "/textures/blocks/receiver_fx.png",
+    "/textures/blocks/receiver_fx_red.png",
+    "/textures/blocks/receiver_fx_green.png",
+    "/textures/blocks/receiver_fx_blue.png",
+    "/textures/blocks/target.png"
+};
 
-    rotation = glm::radians(rotation);
+struct photon_block_vertex{
+    glm::vec2 location;
+    glm::vec2 uv;
+    float fac;
+};
 
-    glm::mat3 matrix;
-    matrix[0] = glm::vec3( glm::cos(rotation), glm::sin(rotation), 0.0f);
-    matrix[1] = glm::vec3(-glm::sin(rotation), glm::cos(rotation), 0.0f);
+// quads waiting for DrawQueued().
+static std::vector<photon_block_vertex> queue;
 
-    matrix *= size;
-    matrix[2] = glm::vec3(location, 1.0f);
+// reused every frame, grown when a frame needs more.
+static GLuint vertex_buffer = 0;
+static GLuint index_buffer = 0;
+static size_t vertex_buffer_size = 0;
+static uint32_t index_buffer_quads = 0;
 
-    opengl::SetModelMatrix(matrix);
+void QueueBlock(block_texture texture, glm::vec2 location, float size, uint8_t rotation, float fac){
+    static const glm::vec2 verts[] = {glm::vec2( 1.0f, 1.0f),
+                                      glm::vec2( 1.0f,-1.0f),
+                                      glm::vec2(-1.0f,-1.0f),
+                                      glm::vec2(-1.0f, 1.0f)};
 
-    glVertexAttribPointer(PHOTON_VERTEX_LOCATION_ATTRIBUTE, 2, GL_FLOAT, GL_FALSE, 0, verts);
-    glVertexAttribPointer(PHOTON_VERTEX_UV_ATTRIBUTE,       2, GL_FLOAT, GL_FALSE, 0, uv);
-    glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+    static const glm::vec2 uv[] = {glm::vec2(1.0f, 0.0f),
+                                   glm::vec2(1.0f, 1.0f),
+                                   glm::vec2(0.0f, 1.0f),
+                                   glm::vec2(0.0f, 0.0f)};
+
+    float angle = glm::radians(rotation * (360.0f / PHOTON_ROTATION_STEPS));
+    glm::vec2 x_axis = glm::vec2( glm::cos(angle), glm::sin(angle)) * size;
+    glm::vec2 y_axis = glm::vec2(-glm::sin(angle), glm::cos(angle)) * size;
+
+    const glm::vec4 &rect = uv_rects[texture];
+    for(uint32_t i = 0; i < 4; i++){
+        queue.push_back({location + x_axis * verts[i].x + y_axis * verts[i].y, glm::mix(glm::vec2(rect.x, rect.y), glm::vec2(rect.z, rect.w), uv[i]), fac});
+    }
 }
 
-void Draw(photon_block block, glm::vec2 location){
-    switch(block.type){
-    default:
-        break;
-    case plain:
-        glBindTexture(GL_TEXTURE_2D, texture_plain_block);
-        DrawBlock(location);
-        break;
-    case indestructible:
-        glBindTexture(GL_TEXTURE_2D, texture_indestructible_block);
-        DrawBlock(location);
-        break;
-    case mirror:
-    case mirror_locked:
-        glBindTexture(GL_TEXTURE_2D, texture_mirror);
-        DrawBlock(location, 0.4f, block.angle);
-        break;
-    case target:
-        glBindTexture(GL_TEXTURE_2D, texture_target);
-        DrawBlock(location);
-        break;
-    case tnt:
-        glBindTexture(GL_TEXTURE_2D, texture_tnt);
-        DrawBlock(location);
-        break;
-    case filter_red:
-        glBindTexture(GL_TEXTURE_2D, texture_filter_red);
-        DrawBlock(location, 0.2f);
-        break;
-    case filter_green:
-        glBindTexture(GL_TEXTURE_2D, texture_filter_green);
-        DrawBlock(location, 0.2f);
-        break;
-    case filter_blue:
-        glBindTexture(GL_TEXTURE_2D, texture_filter_blue);
-        DrawBlock(location, 0.2f);
-        break;
-    case filter_yellow:
-        glBindTexture(GL_TEXTURE_2D, texture_filter_yellow);
-        DrawBlock(location, 0.2f);
-        break;
-    case filter_cyan:
-        glBindTexture(GL_TEXTURE_2D, texture_filter_cyan);
-        DrawBlock(location, 0.2f);
-        break;
-    case filter_magenta:
-        glBindTexture(GL_TEXTURE_2D, texture_filter_magenta);
-        DrawBlock(location, 0.2f);
-        break;
-    case emitter_white:
-    case emitter_red:
-    case emitter_green:
-    case emitter_blue:
-        glBindTexture(GL_TEXTURE_2D, texture_emitter);
-        DrawBlock(location, 0.5f, block.angle);
-        break;
-    case receiver:
-    case receiver_white:
-    case receiver_red:
-    case receiver_green:
-    case receiver_blue:
-        glBindTexture(GL_TEXTURE_2D, texture_receiver);
-        DrawBlock(location, 0.5f, block.angle);
-        break;
-    case move:
-    case move_reverse:{
-        // TODO - make texture.
-        glBindTexture(GL_TEXTURE_2D, texture_indestructible_block);
+void QueueDraw(photon_block block, glm::vec2 location){
+    const photon_block_traits &traits = GetTraits(block.type);
+    if(traits.texture == block_texture_none){
+        return;
+    }
+
+    if(block.type == move || block.type == move_reverse){
+        // drawn part way to where it is being pushed.
         glm::vec2 offset(location);
 
-        if(block.angle == 0.0f){
+        if(block.rotation == 0){
             offset.x += block.power;
-        }else if(block.angle == 90.0f){
+        }else if(block.rotation == 4){
             offset.y += block.power;
-        }else if(block.angle == 180.0f){
+        }else if(block.rotation == 8){
             offset.x -= block.power;
-        }else if(block.angle == 270.0f){
+        }else if(block.rotation == 12){
             offset.y -= block.power;
         }
-        DrawBlock(offset);
-        break;
+        QueueBlock(traits.texture, offset, traits.draw_scale, 0, 1.0f);
+    }else{
+        QueueBlock(traits.texture, location, traits.draw_scale, traits.has_rotation ? block.rotation : 0, 1.0f);
     }
+}
+
+void QueueDrawFX(photon_block block, glm::vec2 location){
+    const photon_block_traits &traits = GetTraits(block.type);
+    if(traits.fx_texture == block_texture_none){
+        return;
+    }
+
+    if(traits.has_rotation){
+        // receivers, which glow a little even when they aren't powered.
+        QueueBlock(traits.fx_texture, location, traits.draw_scale, block.rotation, block.power + 0.2f);
+    }else{
+        QueueBlock(traits.fx_texture, location, traits.draw_scale, 0, block.power);
     }
 }
 
-GLuint GetBlockTexture(block_type type){
-    switch(type){
-    default:
-        return 0;
-        break;
-    case plain:
-        return texture_plain_block;
-        break;
-    case indestructible:
-        return texture_indestructible_block;
-        break;
-    case mirror:
-    case mirror_locked:
-        return texture_mirror;
-        break;
-    case tnt:
-        return texture_tnt;
-        break;
-    case filter_red:
-        return texture_filter_red;
-        break;
-    case filter_green:
-        return texture_filter_green;
-        break;
-    case filter_blue:
-        return texture_filter_blue;
-        break;
-    case filter_yellow:
-        return texture_filter_yellow;
-        break;
-    case filter_cyan:
-        return texture_filter_cyan;
-        break;
-    case filter_magenta:
-        return texture_filter_magenta;
-        break;
-    case emitter_white:
-    case emitter_red:
-    case emitter_green:
-    case emitter_blue:
-        return texture_emitter;
-        break;
-    case receiver:
-    case receiver_white:
-    case receiver_red:
-    case receiver_green:
-    case receiver_blue:
-        return texture_receiver;
-        break;
+bool DrawsStatic(block_type type){
+    return type != move && type != move_reverse;
+}
+
+// draws quads from the vertex buffer bound to GL_ARRAY_BUFFER.
+void DrawBoundBuffer(uint32_t quads){
+    if(index_buffer == 0){
+        glGenBuffers(1, &index_buffer);
+    }
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer);
+
+    // the indices are the same every frame, only rebuild them when there are more quads than before.
+    if(quads > index_buffer_quads){
+        index_buffer_quads = std::max(quads, index_buffer_quads * 2);
+
+        std::vector<GLuint> indices;
+        indices.reserve(index_buffer_quads * 6);
+        for(GLuint quad = 0; quad < index_buffer_quads; quad++){
+            GLuint first = quad * 4;
+            indices.insert(indices.end(), {first, first + 1, first + 2, first, first + 2, first + 3});
+        }
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
     }
+
+    // vertices are already in level coordinates.
+    opengl::SetModelMatrix(glm::mat3(1.0f));
+
+    glEnableVertexAttribArray(PHOTON_VERTEX_FAC_ATTRIBUTE);
+    glVertexAttribPointer(PHOTON_VERTEX_LOCATION_ATTRIBUTE, 2, GL_FLOAT, GL_FALSE, sizeof(photon_block_vertex), (void*)offsetof(photon_block_vertex, location));
+    glVertexAttribPointer(PHOTON_VERTEX_UV_ATTRIBUTE,       2, GL_FLOAT, GL_FALSE, sizeof(photon_block_vertex), (void*)offsetof(photon_block_vertex, uv));
+    glVertexAttribPointer(PHOTON_VERTEX_FAC_ATTRIBUTE,      1, GL_FLOAT, GL_FALSE, sizeof(photon_block_vertex), (void*)offsetof(photon_block_vertex, fac));
+
+    glBindTexture(GL_TEXTURE_2D, atlas);
+    glDrawElements(GL_TRIANGLES, GLsizei(quads * 6), GL_UNSIGNED_INT, nullptr);
+
+    // everything else draws from client memory.
+    glDisableVertexAttribArray(PHOTON_VERTEX_FAC_ATTRIBUTE);
+    glVertexAttrib1f(PHOTON_VERTEX_FAC_ATTRIBUTE, 1.0f);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+void DrawQueued(){
+    size_t vertex_count = queue.size();
+    if(vertex_count == 0){
+        return;
+    }
+
+    if(vertex_buffer == 0){
+        glGenBuffers(1, &vertex_buffer);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+
+    size_t size = vertex_count * sizeof(photon_block_vertex);
+    if(size > vertex_buffer_size){
+        vertex_buffer_size = std::max(size, vertex_buffer_size * 2);
+    }
+    // passing nullptr first lets the driver hand out fresh memory instead of waiting on last frame's draw.
+    glBufferData(GL_ARRAY_BUFFER, vertex_buffer_size, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, size, queue.data());
+
+    DrawBoundBuffer(vertex_count / 4);
+    queue.clear();
+}
+
+void BuildMesh(photon_block_mesh &mesh){
+    mesh.quads = queue.size() / 4;
+    if(mesh.quads > 0){
+        if(mesh.vertex_buffer == 0){
+            glGenBuffers(1, &mesh.vertex_buffer);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, mesh.vertex_buffer);
+        glBufferData(GL_ARRAY_BUFFER, queue.size() * sizeof(photon_block_vertex), queue.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+    queue.clear();
+}
+
+void DrawMesh(const photon_block_mesh &mesh){
+    if(mesh.quads > 0){
+        glBindBuffer(GL_ARRAY_BUFFER, mesh.vertex_buffer);
+        DrawBoundBuffer(mesh.quads);
+    }
+}
+
+void DeleteMesh(photon_block_mesh &mesh){
+    if(mesh.vertex_buffer != 0){
+        glDeleteBuffers(1, &mesh.vertex_buffer);
+    }
+    mesh = photon_block_mesh();
+}
+
+void Draw(photon_block block, glm::vec2 location){
+    QueueDraw(block, location);
+    DrawQueued();
 }
 
 void DrawFX(photon_block block, glm::vec2 location){
-    switch(block.type){
+    QueueDrawFX(block, location);
+    opengl::SetFacFX(1.0f);
+    DrawQueued();
+}
+
+// the image the gui shows for an item, the same as the block's texture except for
+// move blocks (which only borrow the indestructible block's) & targets, which have never had an icon.
+block_texture GetIconTexture(block_type type){
+    switch(type){
+    case move:
+    case move_reverse:
+    case target:
+        return block_texture_none;
     default:
-        break;
-    case tnt:
-        glBindTexture(GL_TEXTURE_2D, texture_filter_red);
-        opengl::SetFacFX(block.power);
-        DrawBlock(location);
-        break;
-    case tnt_fireball:
-        glBindTexture(GL_TEXTURE_2D, texture_explosion);
-        opengl::SetFacFX(block.power);
-        DrawBlock(location, 1.5);
-        break;
-    case receiver:
-    case receiver_white:
-        glBindTexture(GL_TEXTURE_2D, texture_receiver_fx);
-        opengl::SetFacFX(block.power + 0.2f);
-        DrawBlock(location, 0.5f, block.angle);
-        break;
-    case receiver_red:
-        glBindTexture(GL_TEXTURE_2D, texture_receiver_fx_red);
-        opengl::SetFacFX(block.power + 0.2f);
-        DrawBlock(location, 0.5f, block.angle);
-        break;
-    case receiver_green:
-        glBindTexture(GL_TEXTURE_2D, texture_receiver_fx_green);
-        opengl::SetFacFX(block.power + 0.2f);
-        DrawBlock(location, 0.5f, block.angle);
-        break;
-    case receiver_blue:
-        glBindTexture(GL_TEXTURE_2D, texture_receiver_fx_blue);
-        opengl::SetFacFX(block.power + 0.2f);
-        DrawBlock(location, 0.5f, block.angle);
-        break;
+        return GetTraits(type).texture;
     }
 }
 
+GLuint GetBlockTexture(block_type type){
+    return GetIconTexture(type) == block_texture_none ? 0 : atlas;
+}
+
+glm::vec4 GetBlockUV(block_type type){
+    return uv_rects[GetIconTexture(type)];
+}
+
 void LoadTextures(){
-    texture_plain_block = texture::Load("/textures/blocks/block.png");
-    texture_indestructible_block = texture::Load("/textures/blocks/indestructible_block.png");
-    texture_mirror = texture::Load("/textures/blocks/mirror.png");
-    texture_tnt = texture::Load("/textures/blocks/tnt.png");
-    texture_filter_red = texture::Load("/textures/blocks/filter_red.png");
-    texture_filter_green = texture::Load("/textures/blocks/filter_green.png");;
-    texture_filter_blue = texture::Load("/textures/blocks/filter_blue.png");;
-    texture_filter_yellow = texture::Load("/textures/blocks/filter_yellow.png");
-    texture_filter_cyan = texture::Load("/textures/blocks/filter_cyan.png");;
-    texture_filter_magenta = texture::Load("/textures/blocks/filter_magenta.png");;
-    texture_emitter = texture::Load("/textures/blocks/emitter.png");
-    texture_receiver = texture::Load("/textures/blocks/receiver.png");
-    texture_receiver_fx = texture::Load("/textures/blocks/receiver_fx.png");
-    texture_receiver_fx_red = texture::Load("/textures/blocks/receiver_fx_red.png");
-    texture_receiver_fx_green = texture::Load("/textures/blocks/receiver_fx_green.png");
-    texture_receiver_fx_blue = texture::Load("/textures/blocks/receiver_fx_blue.png");
-    texture_explosion = texture::Load("/textures/explosion.png");
-    texture_target = texture::Load("/textures/blocks/target.png");
+    std::vector<std::string> filenames;
+    for(uint32_t i = block_texture_none + 1; i < block_texture_count; i++){
+        filenames.push_back(texture_files[i]);
+    }
+    std::vector<glm::vec4> rects;
+    atlas = texture::LoadAtlas(filenames, rects);
+
+    for(uint32_t i = block_texture_none + 1; i < block_texture_count; i++){
+        uv_rects[i] = rects[i - (block_texture_none + 1)];
+    }
+}
+
+void GarbageCollect(){
+    // deleted by texture::GarbageCollect().
+    atlas = 0;
+
+    if(vertex_buffer != 0){
+        glDeleteBuffers(1, &vertex_buffer);
+        vertex_buffer = 0;
+        vertex_buffer_size = 0;
+    }
+    if(index_buffer != 0){
+        glDeleteBuffers(1, &index_buffer);
+        index_buffer = 0;
+        index_buffer_quads = 0;
+    }
 }
 
 
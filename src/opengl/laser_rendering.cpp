@@ -7,7 +7,7 @@ namespace photon{
 
 namespace opengl{
 
-void DrawLaserSegment(photon_lasersegment &segment){
+void DrawLaserSegment(photon_laserbeam &beam, photon_lasersegment &segment){
     // TODO - this function is really messy, I should probably clean it up...
     static const float uv[] = { 1.0f, 0.0f,
                                 0.0f, 0.0f,
@@ -22,14 +22,14 @@ void DrawLaserSegment(photon_lasersegment &segment){
     glm::vec2 child_offset(0.0f);
     glm::vec2 parent_offset(0.0f);
 
-    if(segment.child != nullptr && segment.angle != segment.child->angle){
-        float child_angle = segment.angle - segment.child->angle;
+    if(segment.child >= 0 && segment.direction != beam.segments[segment.child].direction){
+        float child_angle = (segment.direction - beam.segments[segment.child].direction) * (360.0f / PHOTON_DIRECTIONS);
         child_angle = 0.5f * -fmod(child_angle + 180.0f, 360.0f);
 
         child_offset = glm::rotate(tangent * glm::tan(glm::radians(child_angle)), glm::half_pi<float>());
     }
-    if(segment.parent != nullptr && segment.angle != segment.parent->angle){
-        float parent_angle = segment.parent->angle - segment.angle;
+    if(segment.parent >= 0 && segment.direction != beam.segments[segment.parent].direction){
+        float parent_angle = (beam.segments[segment.parent].direction - segment.direction) * (360.0f / PHOTON_DIRECTIONS);
         parent_angle = 0.5f * -fmod(parent_angle + 180.0f, 360.0f);
 
         parent_offset = glm::rotate(tangent * glm::tan(glm::radians(parent_angle)), glm::half_pi<float>());
@@ -54,7 +54,7 @@ void DrawLaserSegment(photon_lasersegment &segment){
 void DrawLaser(photon_laserbeam &beam){
     opengl::SetModelMatrix(glm::mat3(1.0f));
     for(photon_lasersegment &segment : beam.segments){
-        DrawLaserSegment(segment);
+        DrawLaserSegment(beam, segment);
     }
 }
 
@@ -77,7 +77,7 @@ void DrawLaserSegmentLight(photon_lasersegment &segment){
 
     opengl::SetLaserColor(segment.color);
 
-    float radians = glm::radians(segment.angle - 90);
+    float radians = glm::radians(segment.direction * (360.0f / PHOTON_DIRECTIONS) - 90);
     float dist = glm::distance(glm::vec2(segment.start), glm::vec2(segment.end));
 
     glm::mat3 matrix = glm::mat3( glm::cos(radians) * size, glm::sin(radians) * size, 0.0f,
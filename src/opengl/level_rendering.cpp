@@ -0,0 +1,163 @@
+#include "photon_opengl.h"
+
+namespace photon{
+
+namespace level{
+
+// blends the power of blocks that change over time with their power before the last tick.
+photon_block InterpolateBlock(const photon_level &level, photon_block block, glm::uvec2 location, float interpolation){
+    if(interpolation < 1.0f && blocks::NeedsFrameUpdate(block.type)){
+        block.power = glm::mix(GetPreviousPower(level, location, float(block.power)), float(block.power), interpolation);
+    }
+    return block;
+}
+
+// chunks are drawn in square regions of PHOTON_REGION_SIZE chunks a side, one draw call for each region on screen.
+#define PHOTON_REGION_SHIFT 2
+#define PHOTON_REGION_SIZE (1 << PHOTON_REGION_SHIFT)
+// how far past its location a block can be drawn. (pushed part way to the next block or scaled up)
+#define PHOTON_REGION_VIEW_MARGIN 2.0f
+
+// the static blocks of a region baked into a mesh, plus the blocks that have to be drawn every frame.
+struct photon_level_region{
+    photon_block_mesh mesh;
+    // the version of each of the region's chunks when mesh was built, 0 where there was no chunk. versions are
+    // never reused, so these stop matching when any chunk in the region changes, gets freed, gets allocated
+    // or is replaced by a chunk of another level.
+    uint64_t versions[PHOTON_REGION_SIZE * PHOTON_REGION_SIZE] = {};
+    // blocks that blocks::DrawsStatic() is false for.
+    std::vector<glm::uvec2> dynamic_blocks;
+    // blocks with an fx texture, their fx fade with their power so they are never cached.
+    std::vector<glm::uvec2> fx_blocks;
+};
+
+// keyed by region y in the top 32 bits & region x in the bottom 32. (like level::ChunkKey())
+static std::unordered_map<uint64_t, photon_level_region> regions;
+
+void BuildRegion(photon_level_region &region, const photon_level_chunk *chunk){
+    for(uint32_t i = 0; i < PHOTON_CHUNK_SIZE * PHOTON_CHUNK_SIZE; i++){
+        const photon_block &block = chunk->blocks[i];
+        if(block.type == air){
+            continue;
+        }
+        glm::uvec2 location(chunk->origin.x + i % PHOTON_CHUNK_SIZE, chunk->origin.y + i / PHOTON_CHUNK_SIZE);
+        if(blocks::DrawsStatic(block.type)){
+            blocks::QueueDraw(block, glm::vec2(location));
+        }else{
+            region.dynamic_blocks.push_back(location);
+        }
+        if(blocks::GetTraits(block.type).fx_texture != block_texture_none){
+            region.fx_blocks.push_back(location);
+        }
+    }
+}
+
+// finds the regions on screen & rebuilds the ones that are stale.
+// uses the block queue, so nothing else can be queued when this is called.
+const std::vector<photon_level_region*> &UpdateVisibleRegions(const photon_level &level){
+    static std::vector<photon_level_region*> visible;
+    visible.clear();
+
+    glm::vec4 bounds = opengl::GetViewBounds();
+    float margin = PHOTON_REGION_VIEW_MARGIN;
+    if(level.width == 0 || level.height == 0 ||
+       bounds.z + margin < 0.0f || bounds.x - margin > float(level.width - 1) ||
+       bounds.w + margin < 0.0f || bounds.y - margin > float(level.height - 1)){
+        return visible;
+    }
+    glm::uvec2 first(std::max(bounds.x - margin, 0.0f), std::max(bounds.y - margin, 0.0f));
+    glm::uvec2 last(std::min(bounds.z + margin, float(level.width - 1)), std::min(bounds.w + margin, float(level.height - 1)));
+
+    const uint32_t shift = PHOTON_CHUNK_SHIFT + PHOTON_REGION_SHIFT;
+    for(uint32_t y = first.y >> shift; y <= last.y >> shift; y++){
+        for(uint32_t x = first.x >> shift; x <= last.x >> shift; x++){
+            photon_level_region &region = regions[(uint64_t(y) << 32) | x];
+
+            const photon_level_chunk *chunks[PHOTON_REGION_SIZE * PHOTON_REGION_SIZE] = {};
+            bool stale = false;
+            for(uint32_t i = 0; i < PHOTON_REGION_SIZE * PHOTON_REGION_SIZE; i++){
+                glm::uvec2 origin((x << shift) + (i % PHOTON_REGION_SIZE) * PHOTON_CHUNK_SIZE,
+                                  (y << shift) + (i / PHOTON_REGION_SIZE) * PHOTON_CHUNK_SIZE);
+                auto chunk = level.grid.find(ChunkKey(origin));
+                uint64_t version = 0;
+                if(chunk != level.grid.end()){
+                    chunks[i] = &chunk->second;
+                    version = chunk->second.version;
+                }
+                if(version != region.versions[i]){
+                    region.versions[i] = version;
+                    stale = true;
+                }
+            }
+
+            if(stale){
+                region.dynamic_blocks.clear();
+                region.fx_blocks.clear();
+                for(const photon_level_chunk *chunk : chunks){
+                    if(chunk != nullptr){
+                        BuildRegion(region, chunk);
+                    }
+                }
+                blocks::BuildMesh(region.mesh);
+            }
+
+            visible.push_back(&region);
+        }
+    }
+    return visible;
+}
+
+void Draw(photon_level &level, float interpolation){
+    const std::vector<photon_level_region*> &visible = UpdateVisibleRegions(level);
+
+    for(photon_level_region *region : visible){
+        blocks::DrawMesh(region->mesh);
+    }
+
+    for(photon_level_region *region : visible){
+        for(glm::uvec2 location : region->dynamic_blocks){
+            const photon_block *block = GetBlock(level, location);
+            if(block != nullptr){
+                blocks::QueueDraw(InterpolateBlock(level, *block, location, interpolation), glm::vec2(location));
+            }
+        }
+    }
+    blocks::DrawQueued();
+}
+
+void DrawBeams(photon_level &level){
+    for(photon_laserbeam &beam : level.beams){
+        opengl::DrawLaser(beam);
+    }
+}
+
+void DrawBeamsLight(photon_level &level){
+    for(photon_laserbeam &beam : level.beams){
+        opengl::DrawLaserLight(beam);
+    }
+}
+
+void DrawFX(photon_level &level, float interpolation){
+    for(photon_level_region *region : UpdateVisibleRegions(level)){
+        for(glm::uvec2 location : region->fx_blocks){
+            const photon_block *block = GetBlock(level, location);
+            if(block != nullptr){
+                blocks::QueueDrawFX(InterpolateBlock(level, *block, location, interpolation), glm::vec2(location));
+            }
+        }
+    }
+    // the fac of each block is in its vertices.
+    opengl::SetFacFX(1.0f);
+    blocks::DrawQueued();
+}
+
+void GarbageCollect(){
+    for(auto &region : regions){
+        blocks::DeleteMesh(region.second.mesh);
+    }
+    regions.clear();
+}
+
+}
+
+}
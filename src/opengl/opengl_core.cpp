@@ -15,6 +15,110 @@ photon_shader shader_text;
 GLuint photon_texture;
 GLuint background;
 
+// the shader glUseProgram() was last called with, only changed through UseShader().
+photon_shader *current_shader = nullptr;
+
+// camera state shared by every shader. changing it only bumps version,
+// each shader uploads the new matrices the next time it is used.
+struct photon_camera{
+    float aspect = 1.0f;
+    float zoom = 1.0f;
+    glm::vec2 center;
+
+    // world space to screen space.
+    glm::mat3 view;
+    // gui space to screen space, only corrects for aspect ratio.
+    glm::mat3 view_gui;
+
+    uint32_t version = 1;
+} camera;
+
+void UploadCamera(photon_shader &shader){
+    if(shader.camera_version != camera.version){
+        if(shader.uniform_view > -1){
+            glUniformMatrix3fv(shader.uniform_view, 1, GL_FALSE, glm::value_ptr(camera.view));
+        }
+        if(shader.uniform_view_gui > -1){
+            glUniformMatrix3fv(shader.uniform_view_gui, 1, GL_FALSE, glm::value_ptr(camera.view_gui));
+        }
+        shader.camera_version = camera.version;
+    }
+}
+
+void UseShader(photon_shader &shader){
+    if(current_shader != &shader){
+        glUseProgram(shader.program);
+        current_shader = &shader;
+    }
+    UploadCamera(shader);
+}
+
+void UpdateCamera(float aspect, float zoom, const glm::vec2 &center){
+    if(aspect == camera.aspect && zoom == camera.zoom && center == camera.center){
+        return;
+    }
+    camera.aspect = aspect;
+    camera.zoom = zoom;
+    camera.center = center;
+
+    glm::vec2 scale(1.0f);
+    if(aspect > 1.0f){
+        scale.x /= aspect;
+    }else if(aspect < 1.0f){
+        scale.y *= aspect;
+    }
+
+    camera.view_gui = glm::mat3(glm::vec3(scale.x, 0.0f, 0.0f),
+                                glm::vec3(0.0f, scale.y, 0.0f),
+                                glm::vec3(0.0f, 0.0f, 1.0f));
+
+    scale /= zoom;
+    camera.view = glm::mat3(glm::vec3(scale.x, 0.0f, 0.0f),
+                            glm::vec3(0.0f, scale.y, 0.0f),
+                            glm::vec3(-center.x * scale.x, -center.y * scale.y, 1.0f));
+
+    ++camera.version;
+
+    // no UseShader() call is coming to refresh the shader that is already in use.
+    if(current_shader != nullptr){
+        UploadCamera(*current_shader);
+    }
+}
+
+// uniforms are set on the current program, so switch to shader for a moment if it isn't current.
+template<typename T, typename F>
+void SetUniform(photon_shader &shader, GLint location, T &current_value, const T &value, F upload){
+    if(location < 0 || current_value == value){
+        return;
+    }
+    current_value = value;
+
+    photon_shader *previous = current_shader;
+    UseShader(shader);
+    upload(location, value);
+    if(previous != nullptr){
+        UseShader(*previous);
+    }
+}
+
+void SetUniform(photon_shader &shader, GLint location, float &current_value, float value){
+    SetUniform(shader, location, current_value, value, [](GLint location, float value){
+        glUniform1f(location, value);
+    });
+}
+
+void SetUniform(photon_shader &shader, GLint location, glm::vec2 &current_value, const glm::vec2 &value){
+    SetUniform(shader, location, current_value, value, [](GLint location, const glm::vec2 &value){
+        glUniform2fv(location, 1, glm::value_ptr(value));
+    });
+}
+
+void SetUniform(photon_shader &shader, GLint location, glm::mat3 &current_value, const glm::mat3 &value){
+    SetUniform(shader, location, current_value, value, [](GLint location, const glm::mat3 &value){
+        glUniformMatrix3fv(location, 1, GL_FALSE, glm::value_ptr(value));
+    });
+}
+
 void InitOpenGL(photon_window &window){
     PrintToLog("INFO: Initializing OpenGL.");
     SDL_GL_MakeCurrent(window.window_SDL, window.context_SDL);
@@ -65,12 +169,15 @@ void InitOpenGL(photon_window &window){
 
     glEnableVertexAttribArray(PHOTON_VERTEX_LOCATION_ATTRIBUTE);
     glEnableVertexAttribArray(PHOTON_VERTEX_UV_ATTRIBUTE);
+    glVertexAttrib1f(PHOTON_VERTEX_FAC_ATTRIBUTE, 1.0f);
 
     shader_scene = LoadShaderXML("/shaders/scene.xml");
     shader_laser = LoadShaderXML("/shaders/laser.xml");
     shader_light = LoadShaderXML("/shaders/light.xml");
     shader_fx = LoadShaderXML("/shaders/fx.xml");
     shader_text = LoadShaderXML("/shaders/text.xml");
+    // LoadShaderXML() leaves no program in use.
+    current_shader = nullptr;
 
     blocks::LoadTextures();
 
@@ -88,6 +195,8 @@ void GarbageCollect(photon_window &window){
     CheckOpenGLErrors();
 
     texture::GarbageCollect();
+    blocks::GarbageCollect();
+    level::GarbageCollect();
 
     DeleteShader(shader_scene);
 
@@ -99,19 +208,7 @@ void OnResize(uint32_t width, uint32_t height, photon_window &window){
 
     PrintToLog("INFO: Resizing window to %ix%i.", width, height);
 
-    float aspect = (float)width/(float)height;
-
-    glUseProgram(shader_scene.program);
-
-    glUniform1f(glGetUniformLocation(shader_scene.program, "aspect"), aspect);
-    glUseProgram(shader_laser.program);
-    glUniform1f(glGetUniformLocation(shader_laser.program, "aspect"), aspect);
-    glUseProgram(shader_light.program);
-    glUniform1f(glGetUniformLocation(shader_light.program, "aspect"), aspect);
-    glUseProgram(shader_fx.program);
-    glUniform1f(glGetUniformLocation(shader_fx.program,   "aspect"), aspect);
-    glUseProgram(shader_text.program);
-    glUniform1f(glGetUniformLocation(shader_text.program, "aspect"), aspect);
+    UpdateCamera((float)width/(float)height, camera.zoom, camera.center);
 
     glViewport(0, 0, width, height);
 
@@ -150,25 +247,18 @@ GLenum CheckOpenGLErrors(){
 }
 
 void UpdateZoom(const float &zoom){
-    glUseProgram(shader_scene.program);
-    glUniform1f(glGetUniformLocation(shader_scene.program, "zoom"), 1.0f / zoom);
-    glUseProgram(shader_laser.program);
-    glUniform1f(glGetUniformLocation(shader_laser.program, "zoom"), 1.0f / zoom);
-    glUseProgram(shader_light.program);
-    glUniform1f(glGetUniformLocation(shader_light.program, "zoom"), 1.0f / zoom);
-    glUseProgram(shader_fx.program);
-    glUniform1f(glGetUniformLocation(shader_fx.program,    "zoom"), 1.0f / zoom);
+    UpdateCamera(camera.aspect, zoom, camera.center);
 }
 
 void UpdateCenter(const glm::vec2 &center){
-    glUseProgram(shader_scene.program);
-    glUniform2fv(glGetUniformLocation(shader_scene.program, "center"), 1, glm::value_ptr(center));
-    glUseProgram(shader_laser.program);
-    glUniform2fv(glGetUniformLocation(shader_laser.program, "center"), 1, glm::value_ptr(center));
-    glUseProgram(shader_light.program);
-    glUniform2fv(glGetUniformLocation(shader_light.program, "center"), 1, glm::value_ptr(center));
-    glUseProgram(shader_fx.program);
-    glUniform2fv(glGetUniformLocation(shader_fx.program,    "center"), 1, glm::value_ptr(center));
+    UpdateCamera(camera.aspect, camera.zoom, center);
+}
+
+glm::vec4 GetViewBounds(){
+    // how far the edges of the screen are from the center, undoing the scale in camera.view.
+    glm::vec2 extent(1.0f / camera.view[0][0], 1.0f / camera.view[1][1]);
+    return glm::vec4(camera.center.x - extent.x, camera.center.y - extent.y,
+                     camera.center.x + extent.x, camera.center.y + extent.y);
 }
 
 void DrawModeScene(photon_window &window){
@@ -191,7 +281,7 @@ void DrawModeLaser(photon_window &window){
     glEnable(GL_BLEND);
     glBlendFunc(GL_ONE, GL_ONE);
 
-    glUseProgram(shader_laser.program);
+    UseShader(shader_laser);
 }
 
 void DrawModeLevel(photon_window &window){
@@ -202,7 +292,7 @@ void DrawModeLevel(photon_window &window){
     glEnable(GL_BLEND);
     glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
 
-    glUseProgram(shader_scene.program);
+    UseShader(shader_scene);
 
     glActiveTexture(PHOTON_TEXTURE_UNIT_LIGHT);
     glBindTexture(GL_TEXTURE_2D, window.light_buffer_texture);
@@ -219,7 +309,7 @@ void DrawModeLight(photon_window &window){
     glEnable(GL_BLEND);
     glBlendFunc(GL_ONE, GL_ONE);
 
-    glUseProgram(shader_light.program);
+    UseShader(shader_light);
 
     glActiveTexture(PHOTON_TEXTURE_UNIT_LIGHT);
     glBindTexture(GL_TEXTURE_2D, 0);
@@ -274,34 +364,35 @@ void DrawModeGUI(photon_window &window){
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-    glUseProgram(shader_text.program);
+    UseShader(shader_text);
 }
 
 void SetColorGUI(const glm::vec4 &color){
-    glUseProgram(shader_text.program);
-    glUniform4fv(glGetUniformLocation(shader_text.program, "color"), 1, glm::value_ptr(color));
+    SetUniform(shader_text, shader_text.uniform_color, shader_text.color, color, [](GLint location, const glm::vec4 &value){
+        glUniform4fv(location, 1, glm::value_ptr(value));
+    });
 }
 
 void SetCenterGUI(const glm::vec2 &center){
-    glUseProgram(shader_text.program);
-    glUniform2fv(glGetUniformLocation(shader_text.program, "center"), 1, glm::value_ptr(center));
+    SetUniform(shader_text, shader_text.uniform_center, shader_text.center, center);
 }
 
 void SetFacFX(const float &fac){
-    glUniform1f(glGetUniformLocation(shader_fx.program, "fac"), fac);
+    SetUniform(shader_fx, shader_fx.uniform_fac, shader_fx.fac, fac);
 }
 
 void SetLaserColor(const glm::vec3 &color){
-    glUniform3fv(glGetUniformLocation(shader_laser.program, "color"), 1, glm::value_ptr(color));
-    glUniform3fv(glGetUniformLocation(shader_light.program, "color"), 1, glm::value_ptr(color));
+    // the laser shaders only use rgb.
+    for(photon_shader *shader : {&shader_laser, &shader_light}){
+        SetUniform(*shader, shader->uniform_color, shader->color, glm::vec4(color, 1.0f), [](GLint location, const glm::vec4 &value){
+            glUniform3fv(location, 1, glm::value_ptr(value));
+        });
+    }
 }
 
 void SetModelMatrix(const glm::mat3 &matrix){
-    GLint program = 0;
-    glGetIntegerv(GL_CURRENT_PROGRAM, &program);
-    GLint uniform = glGetUniformLocation(program, "model");
-    if(uniform > -1){
-        glUniformMatrix3fv(uniform, 1, GL_FALSE, glm::value_ptr(matrix));
+    if(current_shader != nullptr){
+        SetUniform(*current_shader, current_shader->uniform_model, current_shader->model, matrix);
     }
 }
 
@@ -313,7 +404,7 @@ void DrawModeFX(photon_window &window){
     glEnable(GL_BLEND);
     glBlendFunc(GL_ONE, GL_ONE);
 
-    glUseProgram(shader_fx.program);
+    UseShader(shader_fx);
 
     glActiveTexture(PHOTON_TEXTURE_UNIT_LIGHT);
     glBindTexture(GL_TEXTURE_2D, 0);
@@ -65,7 +65,9 @@ GLuint LoadAndCompileShader(const char *filename, GLenum shader_type){
 }
 
 int LinkShaderProgram(photon_shader &shader){
-    shader.program = glCreateProgram();
+    if(shader.program == 0){
+        shader.program = glCreateProgram();
+    }
 
     for(GLuint shader_object : shader.shader_objects){
         glAttachShader(shader.program, shader_object);
@@ -163,22 +165,18 @@ photon_shader LoadShaderXML(const std::string &filename){
             return shader;
         }
 
+        shader.program = glCreateProgram();
+
+        // attribute locations only take effect when the program is linked, so they get bound first.
+        // (name & location of each one, checked after linking)
+        std::vector<std::pair<std::string, GLint>> inputs;
         xmlNodePtr node = root->xmlChildrenNode;
         while(node != nullptr) {
             if(xmlStrEqual(node->name, (const xmlChar*)"vertex_shader")){
                 ParseShaderObjectXML(shader, doc, node, GL_VERTEX_SHADER, filename);
             }else if(xmlStrEqual(node->name, (const xmlChar*)"fragment_shader")){
                 ParseShaderObjectXML(shader, doc, node, GL_FRAGMENT_SHADER, filename);
-            }
-            node = node->next;
-        }
-        LinkShaderProgram(shader);
-
-        glUseProgram(shader.program);
-
-        node = root->xmlChildrenNode;
-        while(node != nullptr) {
-            if((xmlStrEqual(node->name, (const xmlChar*)"input"))){
+            }else if((xmlStrEqual(node->name, (const xmlChar*)"input"))){
                 xmlChar *input_name = xmlGetProp(node, (const xmlChar*)"name");
                 xmlChar *input_type = xmlGetProp(node, (const xmlChar*)"type");
 
@@ -186,14 +184,38 @@ photon_shader LoadShaderXML(const std::string &filename){
                 PrintToLog("DEBUG: input name %s type %s", input_name, input_type);
 #endif
 
+                GLint location = -1;
                 if(xmlStrEqual(input_type, (const xmlChar*)"location")){
-                    glBindAttribLocation(shader.program, PHOTON_VERTEX_LOCATION_ATTRIBUTE, (const GLchar *)input_name);
+                    location = PHOTON_VERTEX_LOCATION_ATTRIBUTE;
                 }else if(xmlStrEqual(input_type, (const xmlChar*)"uv")){
-                    glBindAttribLocation(shader.program, PHOTON_VERTEX_UV_ATTRIBUTE, (const GLchar *)input_name);
+                    location = PHOTON_VERTEX_UV_ATTRIBUTE;
+                }else if(xmlStrEqual(input_type, (const xmlChar*)"fac")){
+                    location = PHOTON_VERTEX_FAC_ATTRIBUTE;
+                }
+                if(location > -1){
+                    glBindAttribLocation(shader.program, location, (const GLchar *)input_name);
+                    inputs.push_back(std::make_pair(std::string((char*)input_name), location));
                 }
                 xmlFree(input_name);
                 xmlFree(input_type);
-            }else if((xmlStrEqual(node->name, (const xmlChar*)"texture2D"))){
+            }
+            node = node->next;
+        }
+        LinkShaderProgram(shader);
+
+        for(const std::pair<std::string, GLint> &input : inputs){
+            GLint location = glGetAttribLocation(shader.program, input.first.c_str());
+            // -1 means the shader doesn't use it, which is fine.
+            if(location > -1 && location != input.second){
+                PrintToLog("WARNING: input \"%s\" of shader \"%s\" is at location %i instead of %i!", input.first.c_str(), filename.c_str(), location, input.second);
+            }
+        }
+
+        glUseProgram(shader.program);
+
+        node = root->xmlChildrenNode;
+        while(node != nullptr) {
+            if((xmlStrEqual(node->name, (const xmlChar*)"texture2D"))){
                 xmlChar *uniform_name = xmlGetProp(node, (const xmlChar*)"name");
                 GLuint texuniform = glGetUniformLocation(shader.program, (const GLchar *)uniform_name);
 
@@ -214,6 +236,15 @@ photon_shader LoadShaderXML(const std::string &filename){
             node = node->next;
         }
 
+        shader.uniform_view     = glGetUniformLocation(shader.program, "view");
+        shader.uniform_view_gui = glGetUniformLocation(shader.program, "view_gui");
+        shader.uniform_center   = glGetUniformLocation(shader.program, "center");
+        shader.uniform_model    = glGetUniformLocation(shader.program, "model");
+        shader.uniform_color    = glGetUniformLocation(shader.program, "color");
+        shader.uniform_fac      = glGetUniformLocation(shader.program, "fac");
+
+        glUseProgram(0);
+
         delete[] xml_buffer;
         xmlFreeDoc(doc);
     }else{
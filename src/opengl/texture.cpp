@@ -2,6 +2,8 @@
 #include "photon_texture.h"
 
 #include <map>
+#include <algorithm>
+#include <cstring>
 #include <SDL_image.h>
 #include <physfs.h>
 
@@ -11,61 +13,155 @@ namespace texture{
 
 std::map<std::string, GLuint> textures = std::map<std::string, GLuint>();
 
+// loads an image file into an RGBA8888 surface, returns nullptr on failure.
+SDL_Surface *LoadSurface(const std::string &filename){
+    if(!filename.empty() && PHYSFS_exists(filename.c_str())){
+        auto fp = PHYSFS_openRead(filename.c_str());
+        intmax_t length = PHYSFS_fileLength(fp);
+        if(length > 0){
+            uint8_t *buffer = new uint8_t[length];
+
+            PHYSFS_read(fp, buffer, 1, length);
+
+            PHYSFS_close(fp);
+
+            SDL_RWops *rw = SDL_RWFromMem(buffer, length);
+            SDL_Surface *image = IMG_Load_RW(rw, 1);
+
+            delete[] buffer;
+
+            if(image == nullptr){
+                PrintToLog("ERROR: texture loading failed! %s", IMG_GetError());
+                return nullptr;
+            }
+
+            SDL_Surface *converted = SDL_ConvertSurface(image, SDL_AllocFormat(SDL_PIXELFORMAT_RGBA8888), 0);
+            SDL_FreeSurface(image);
+
+            return converted;
+        }
+        PHYSFS_close(fp);
+    }else{
+        PrintToLog("ERROR: Unable to load texture: \"%s\" does not exist!", filename.c_str());
+        return nullptr;
+    }
+    PrintToLog("ERROR: Unable to open texture: \"%s\", unknown error.", filename.c_str());
+    return nullptr;
+}
+
 GLuint Load(const std::string &filename){
     if(textures.count(filename)){
         return textures[filename];
-    }else{
-        if(!filename.empty() && PHYSFS_exists(filename.c_str())){
-            auto fp = PHYSFS_openRead(filename.c_str());
-            intmax_t length = PHYSFS_fileLength(fp);
-            if(length > 0){
-                uint8_t *buffer = new uint8_t[length];
-
-                PHYSFS_read(fp, buffer, 1, length);
-
-                PHYSFS_close(fp);
+    }
+    SDL_Surface *converted = LoadSurface(filename);
+    if(converted == nullptr){
+        return 0;
+    }
 
-                SDL_RWops *rw = SDL_RWFromMem(buffer, length);
-                SDL_Surface *image = IMG_Load_RW(rw, 1);
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, converted->w, converted->h, 0, GL_RGBA, GL_UNSIGNED_INT_8_8_8_8, converted->pixels);
 
-                delete[] buffer;
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-                if(image == nullptr){
-                    PrintToLog("ERROR: texture loading failed! %s", IMG_GetError());
-                    return 0;
-                }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
 
-                SDL_Surface *converted = SDL_ConvertSurface(image, SDL_AllocFormat(SDL_PIXELFORMAT_RGBA8888), 0);
-                SDL_FreeSurface(image);
+    static const float border_color[] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, border_color);
 
-                GLuint texture;
-                glGenTextures(1, &texture);
-                glBindTexture(GL_TEXTURE_2D, texture);
-                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, converted->w, converted->h, 0, GL_RGBA, GL_UNSIGNED_INT_8_8_8_8, converted->pixels);
+    SDL_FreeSurface(converted);
 
-                glGenerateMipmap(GL_TEXTURE_2D);
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    PrintToLog("INFO: Loaded texture \"%s\"", filename.c_str());
+    textures[filename] = texture;
+    return texture;
+}
 
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+uint32_t NextPowerOfTwo(uint32_t value){
+    uint32_t result = 1;
+    while(result < value){
+        result <<= 1;
+    }
+    return result;
+}
 
-                static const float border_color[] = { 0.0f, 0.0f, 0.0f, 0.0f };
-                glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, border_color);
+GLuint LoadAtlas(const std::vector<std::string> &filenames, std::vector<glm::vec4> &rects){
+    rects.assign(filenames.size(), glm::vec4(0.0f));
 
-                SDL_FreeSurface(converted);
+    std::vector<SDL_Surface*> images;
+    for(const std::string &filename : filenames){
+        images.push_back(LoadSurface(filename));
+    }
 
-                PrintToLog("INFO: Loaded texture \"%s\"", filename.c_str());
-                textures[filename] = texture;
-                return texture;
-            }
+    // tallest first, packed left to right in rows.
+    std::vector<uint32_t> order;
+    for(uint32_t i = 0; i < images.size(); i++){
+        if(images[i] != nullptr){
+            order.push_back(i);
+        }
+    }
+    std::stable_sort(order.begin(), order.end(), [&images](uint32_t a, uint32_t b){
+        return images[a]->h > images[b]->h;
+    });
+
+    auto slot_size = [](int size){
+        // padding on both sides, rounded so every image starts on a multiple of the padding.
+        return uint32_t(size + PHOTON_ATLAS_PADDING * 2 + PHOTON_ATLAS_PADDING - 1) / PHOTON_ATLAS_PADDING * PHOTON_ATLAS_PADDING;
+    };
+
+    uint32_t width = PHOTON_ATLAS_WIDTH;
+    for(uint32_t i : order){
+        width = std::max(width, NextPowerOfTwo(slot_size(images[i]->w)));
+    }
 
-        }else{
-            PrintToLog("ERROR: Unable to load texture: \"%s\" does not exist!", filename.c_str());
+    std::vector<glm::uvec2> positions(images.size());
+    glm::uvec2 cursor(0);
+    uint32_t row_height = 0;
+    for(uint32_t i : order){
+        if(cursor.x + slot_size(images[i]->w) > width){
+            cursor = glm::uvec2(0, cursor.y + row_height);
+            row_height = 0;
         }
+        positions[i] = cursor + glm::uvec2(PHOTON_ATLAS_PADDING);
+        cursor.x += slot_size(images[i]->w);
+        row_height = std::max(row_height, slot_size(images[i]->h));
     }
-    PrintToLog("ERROR: Unable to open texture: \"%s\", unknown error.", filename.c_str());
-    return 0;
+    uint32_t height = NextPowerOfTwo(std::max(cursor.y + row_height, 1u));
+
+    // the padding is left transparent, like the border of single textures.
+    std::vector<uint32_t> pixels(width * height, 0);
+    for(uint32_t i : order){
+        SDL_Surface *image = images[i];
+        for(int y = 0; y < image->h; y++){
+            memcpy(&pixels[(positions[i].y + y) * width + positions[i].x], (uint8_t*)image->pixels + y * image->pitch, image->w * sizeof(uint32_t));
+        }
+        rects[i] = glm::vec4(float(positions[i].x) / width, float(positions[i].y) / height,
+                             float(positions[i].x + image->w) / width, float(positions[i].y + image->h) / height);
+        SDL_FreeSurface(image);
+    }
+
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_INT_8_8_8_8, pixels.data());
+
+    // smaller mipmap levels would blend images with their neighbours.
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, PHOTON_ATLAS_MAX_LEVEL);
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    PrintToLog("INFO: Packed %u textures into a %ux%u atlas.", uint32_t(order.size()), width, height);
+
+    // so GarbageCollect() gets it, the name can't clash with a file.
+    textures["<atlas " + std::to_string(texture) + ">"] = texture;
+    return texture;
 }
 
 void GarbageCollect(){
@@ -0,0 +1,425 @@
+#include "photon_sim.h"
+
+#include <physfs.h>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace photon;
+
+// benchmarks the simulation on generated levels:
+// photon_bench [--out <file>] [--baseline <file>] [--threshold <fraction>] [--filter <text>] [--threads <n>] [--quick]
+//              [--size <width>x<height>] [--emitters <n>] [--mirror-density <fraction>] [--filter-density <fraction>] [--seed <n>]
+// any of the level options replaces the preset levels with a single "custom" level, starting from the medium preset.
+
+struct bench_options{
+    std::string out = "photon_bench.json";
+    std::string baseline;
+    // how much slower than the baseline a benchmark can be before it counts as a regression.
+    double threshold = 0.1;
+    // only run benchmarks with this in their name.
+    std::string filter;
+    int threads = 1;
+    // skip the large level & take fewer samples.
+    bool quick = false;
+
+    // used instead of the presets if custom is set.
+    photon_generator_settings level;
+    bool custom = false;
+};
+
+struct bench_result{
+    std::string name;
+    // the level it ran on, results only compare against a baseline generated with the same settings.
+    photon_generator_settings level;
+    uint32_t samples;
+    uint32_t iterations;
+
+    // nanoseconds per iteration.
+    double median_ns;
+    double min_ns;
+    double mean_ns;
+};
+
+struct bench_level{
+    const char *name;
+    photon_generator_settings settings;
+};
+
+static const char *save_filename = "/photon_bench_level.xml";
+
+// runs setup then times iterations calls of func, once to warm up & then samples times.
+bench_result Measure(const std::string &name, const photon_generator_settings &level, uint32_t samples, uint32_t iterations, const std::function<void()> &setup, const std::function<void()> &func){
+    std::vector<double> times;
+
+    for(uint32_t sample = 0; sample <= samples; sample++){
+        setup();
+
+        auto start = std::chrono::steady_clock::now();
+        for(uint32_t i = 0; i < iterations; i++){
+            func();
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        // the first sample is the warm up.
+        if(sample > 0){
+            times.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / double(iterations));
+        }
+    }
+
+    std::sort(times.begin(), times.end());
+
+    bench_result result;
+    result.name = name;
+    result.level = level;
+    result.samples = samples;
+    result.iterations = iterations;
+    result.median_ns = times[times.size() / 2];
+    result.min_ns = times.front();
+    result.mean_ns = 0.0;
+    for(double t : times){
+        result.mean_ns += t;
+    }
+    result.mean_ns /= times.size();
+
+    PrintToLog("INFO: %-32s median %12.0fns min %12.0fns mean %12.0fns", name.c_str(), result.median_ns, result.min_ns, result.mean_ns);
+
+    return result;
+}
+
+// the level the presets & custom levels start from.
+photon_generator_settings MediumLevel(){
+    photon_generator_settings settings;
+    settings.width = 256;
+    settings.height = 256;
+    settings.emitters = 32;
+    settings.mirror_density = 0.05f;
+    settings.filter_density = 0.02f;
+    return settings;
+}
+
+void RunBenchmarks(const bench_options &options, std::vector<bench_result> &results){
+    std::vector<bench_level> levels;
+
+    photon_generator_settings settings;
+    settings.width = 64;
+    settings.height = 64;
+    settings.emitters = 8;
+    settings.mirror_density = 0.05f;
+    settings.filter_density = 0.0f;
+    levels.push_back({"small", settings});
+
+    settings = MediumLevel();
+    levels.push_back({"medium", settings});
+
+    if(!options.quick){
+        settings.width = 1024;
+        settings.height = 1024;
+        settings.emitters = 128;
+        settings.mirror_density = 0.02f;
+        settings.filter_density = 0.01f;
+        levels.push_back({"large", settings});
+    }
+
+    if(options.custom){
+        levels.clear();
+        levels.push_back({"custom", options.level});
+    }
+
+    uint32_t samples = options.quick ? 5 : 15;
+
+    photon_level level;
+    photon_player player;
+
+    auto wanted = [&options](const std::string &name){
+        return options.filter.empty() || name.find(options.filter) != std::string::npos;
+    };
+
+    for(const bench_level &bench : levels){
+        auto generate = [&](){
+            generator::Generate(bench.settings, level, player);
+            // traces the beams.
+            level::AdvanceFrame(level, player, 1.0f / 60.0f);
+        };
+        auto none = [](){};
+        std::string suffix = std::string("/") + bench.name;
+
+        if(wanted("trace_beam" + suffix)){
+            generate();
+            results.push_back(Measure("trace_beam" + suffix, bench.settings, samples, 10, none, [&](){
+                for(photon_laserbeam &beam : level.beams){
+                    tracer::TraceBeam(beam, level);
+                }
+            }));
+        }
+
+        if(wanted("advance_frame" + suffix)){
+            generate();
+            results.push_back(Measure("advance_frame" + suffix, bench.settings, samples, 100, none, [&](){
+                level::AdvanceFrame(level, player, 1.0f / 60.0f);
+            }));
+        }
+
+        if(wanted("retrace_all" + suffix)){
+            generate();
+            results.push_back(Measure("retrace_all" + suffix, bench.settings, samples, 10, none, [&](){
+                level.emitters_changed = true;
+                level::AdvanceFrame(level, player, 1.0f / 60.0f);
+            }));
+        }
+
+        if(wanted("check_victory" + suffix)){
+            generate();
+            level.mode = photon_level::power;
+            results.push_back(Measure("check_victory" + suffix, bench.settings, samples, 1000, none, [&](){
+                level.victory_state = 0;
+                level::CheckVictory(level, player);
+            }));
+            level.mode = photon_level::none;
+        }
+
+        if(wanted("save_level" + suffix)){
+            generate();
+            results.push_back(Measure("save_level" + suffix, bench.settings, samples, 1, none, [&](){
+                level::SaveLevelXML(save_filename, level, player);
+            }));
+        }
+
+        if(wanted("load_level" + suffix)){
+            generate();
+            level::SaveLevelXML(save_filename, level, player);
+            results.push_back(Measure("load_level" + suffix, bench.settings, samples, 1, none, [&](){
+                level::LoadLevelXML(save_filename, level, player);
+            }));
+        }
+
+        // a whole session, 10 seconds of ticks with the player rotating a mirror every 10 ticks.
+        if(wanted("play" + suffix)){
+            std::vector<glm::uvec2> mirrors;
+            uint32_t rng = 0;
+
+            results.push_back(Measure("play" + suffix, bench.settings, samples, 1, [&](){
+                generate();
+                mirrors.clear();
+                for(const photon_level_chunk *chunk : level::GetSortedChunks(level)){
+                    for(uint32_t i = 0; i < PHOTON_CHUNK_SIZE * PHOTON_CHUNK_SIZE; i++){
+                        if(chunk->blocks[i].type == mirror){
+                            mirrors.push_back(chunk->origin + glm::uvec2(i % PHOTON_CHUNK_SIZE, i / PHOTON_CHUNK_SIZE));
+                        }
+                    }
+                }
+                rng = 12345;
+            }, [&](){
+                for(uint32_t tick = 0; tick < 600; tick++){
+                    if(tick % 10 == 0 && !mirrors.empty()){
+                        rng = rng * 1664525u + 1013904223u;
+                        blocks::OnRotate(mirrors[(rng >> 8) % mirrors.size()], level, bool(rng & 0x80000000u));
+                    }
+                    level::AdvanceFrame(level, player, 1.0f / 60.0f);
+                }
+            }));
+        }
+    }
+
+    PHYSFS_delete(save_filename);
+}
+
+bool WriteResults(const std::string &filename, const bench_options &options, const std::vector<bench_result> &results){
+    FILE *out = fopen(filename.c_str(), "w");
+    if(out == nullptr){
+        PrintToLog("ERROR: unable to open \"%s\" for writing!", filename.c_str());
+        return false;
+    }
+
+    fprintf(out, "{\n");
+    fprintf(out, "    \"version\": \"%s\",\n", build_info::version);
+    fprintf(out, "    \"git_sha1\": \"%s\",\n", build_info::git_sha1);
+    fprintf(out, "    \"build_type\": \"%s\",\n", build_info::build_type);
+    fprintf(out, "    \"threads\": %i,\n", options.threads);
+    fprintf(out, "    \"benchmarks\": [\n");
+    for(size_t i = 0; i < results.size(); i++){
+        const bench_result &result = results[i];
+        const photon_generator_settings &level = result.level;
+        fprintf(out, "        {\"name\": \"%s\", \"seed\": %llu, \"width\": %u, \"height\": %u, \"emitters\": %u, \"mirror_density\": %.9g, \"filter_density\": %.9g, "
+                "\"samples\": %u, \"iterations\": %u, \"median_ns\": %.1f, \"min_ns\": %.1f, \"mean_ns\": %.1f}%s\n",
+                result.name.c_str(), (unsigned long long)level.seed, level.width, level.height, level.emitters, level.mirror_density, level.filter_density,
+                result.samples, result.iterations, result.median_ns, result.min_ns, result.mean_ns, i + 1 < results.size() ? "," : "");
+    }
+    fprintf(out, "    ]\n");
+    fprintf(out, "}\n");
+
+    fclose(out);
+
+    PrintToLog("INFO: wrote %u benchmark results to \"%s\"", uint32_t(results.size()), filename.c_str());
+    return true;
+}
+
+// finds the number after key between begin & end, false if it isn't there.
+bool ReadNumber(const std::string &text, const char *key, size_t begin, size_t end, double &value){
+    size_t pos = text.find(std::string("\"") + key + "\"", begin);
+    if(pos == std::string::npos || pos >= end){
+        return false;
+    }
+    value = strtod(text.c_str() + text.find(':', pos) + 1, nullptr);
+    return true;
+}
+
+// reads the name, level & median of each benchmark from a file written by WriteResults(), doesn't care about formatting.
+// benchmarks missing any of those are skipped.
+bool ReadBaseline(const std::string &filename, std::vector<bench_result> &baseline){
+    FILE *in = fopen(filename.c_str(), "rb");
+    if(in == nullptr){
+        PrintToLog("ERROR: unable to open baseline \"%s\"!", filename.c_str());
+        return false;
+    }
+    std::string text;
+    char buffer[4096];
+    size_t length;
+    while((length = fread(buffer, 1, sizeof(buffer), in)) > 0){
+        text.append(buffer, length);
+    }
+    fclose(in);
+
+    static const std::string name_key = "\"name\"";
+
+    for(size_t pos = text.find(name_key); pos != std::string::npos; pos = text.find(name_key, pos)){
+        size_t start = text.find('"', text.find(':', pos) + 1);
+        size_t end = text.find('"', start + 1);
+        if(start == std::string::npos || end == std::string::npos){
+            break;
+        }
+        // the rest of this benchmark's fields.
+        size_t close = text.find('}', end);
+
+        bench_result result = {};
+        result.name = text.substr(start + 1, end - start - 1);
+        double seed, width, height, emitters, mirror_density, filter_density;
+        if(ReadNumber(text, "seed", end, close, seed) && ReadNumber(text, "width", end, close, width) &&
+           ReadNumber(text, "height", end, close, height) && ReadNumber(text, "emitters", end, close, emitters) &&
+           ReadNumber(text, "mirror_density", end, close, mirror_density) && ReadNumber(text, "filter_density", end, close, filter_density) &&
+           ReadNumber(text, "median_ns", end, close, result.median_ns)){
+            result.level.seed = uint64_t(seed);
+            result.level.width = uint32_t(width);
+            result.level.height = uint32_t(height);
+            result.level.emitters = uint32_t(emitters);
+            result.level.mirror_density = float(mirror_density);
+            result.level.filter_density = float(filter_density);
+            baseline.push_back(result);
+        }
+
+        pos = end;
+    }
+
+    return true;
+}
+
+bool SameLevel(const photon_generator_settings &a, const photon_generator_settings &b){
+    return a.seed == b.seed && a.width == b.width && a.height == b.height && a.emitters == b.emitters &&
+           a.mirror_density == b.mirror_density && a.filter_density == b.filter_density;
+}
+
+// returns the number of benchmarks slower than the baseline by more than the threshold.
+uint32_t CompareResults(const bench_options &options, const std::vector<bench_result> &results, const std::vector<bench_result> &baseline){
+    uint32_t regressions = 0;
+
+    for(const bench_result &result : results){
+        auto base = std::find_if(baseline.begin(), baseline.end(), [&result](const bench_result &b){
+            return b.name == result.name && SameLevel(b.level, result.level);
+        });
+        if(base == baseline.end() || base->median_ns <= 0.0){
+            PrintToLog("INFO: %-32s not in baseline", result.name.c_str());
+            continue;
+        }
+        double change = result.median_ns / base->median_ns - 1.0;
+
+        if(change > options.threshold){
+            PrintToLog("WARNING: %-32s %+6.1f%% slower than baseline!", result.name.c_str(), change * 100.0);
+            regressions++;
+        }else{
+            PrintToLog("INFO: %-32s %+6.1f%%", result.name.c_str(), change * 100.0);
+        }
+    }
+
+    return regressions;
+}
+
+int main(int argc, char *argv[]){
+    bench_options options;
+    options.level = MediumLevel();
+
+    for(int i = 1; i < argc; i++){
+        bool has_value = i + 1 < argc;
+        if(!strcmp(argv[i], "--out") && has_value){
+            options.out = argv[++i];
+        }else if(!strcmp(argv[i], "--baseline") && has_value){
+            options.baseline = argv[++i];
+        }else if(!strcmp(argv[i], "--threshold") && has_value){
+            options.threshold = atof(argv[++i]);
+        }else if(!strcmp(argv[i], "--filter") && has_value){
+            options.filter = argv[++i];
+        }else if(!strcmp(argv[i], "--threads") && has_value){
+            options.threads = atoi(argv[++i]);
+        }else if(!strcmp(argv[i], "--quick")){
+            options.quick = true;
+        }else if(!strcmp(argv[i], "--size") && has_value && sscanf(argv[++i], "%ux%u", &options.level.width, &options.level.height) == 2){
+            options.custom = true;
+        }else if(!strcmp(argv[i], "--emitters") && has_value){
+            options.level.emitters = atoi(argv[++i]);
+            options.custom = true;
+        }else if(!strcmp(argv[i], "--mirror-density") && has_value){
+            options.level.mirror_density = atof(argv[++i]);
+            options.custom = true;
+        }else if(!strcmp(argv[i], "--filter-density") && has_value){
+            options.level.filter_density = atof(argv[++i]);
+            options.custom = true;
+        }else if(!strcmp(argv[i], "--seed") && has_value){
+            options.level.seed = strtoull(argv[++i], nullptr, 10);
+            options.custom = true;
+        }else{
+            PrintToLog("usage: %s [--out <file>] [--baseline <file>] [--threshold <fraction>] [--filter <text>] [--threads <n>] [--quick]\n"
+                       "       [--size <width>x<height>] [--emitters <n>] [--mirror-density <fraction>] [--filter-density <fraction>] [--seed <n>]", argv[0]);
+            return 1;
+        }
+    }
+
+    // saving & loading goes through PhysFS, use the current directory for both.
+    PHYSFS_init(argv[0]);
+    PHYSFS_setWriteDir(".");
+    PHYSFS_mount(".", nullptr, 0);
+
+    // the zones would be timed along with what they measure.
+    profiler::SetEnabled(false);
+
+    tracer::InitThreads(options.threads);
+    // the budget would spread retracing over several frames.
+    tracer::SetTraceBudget(0);
+
+    std::vector<bench_result> results;
+    RunBenchmarks(options, results);
+
+    tracer::GarbageCollect();
+    PHYSFS_deinit();
+
+    if(!WriteResults(options.out, options, results)){
+        return 1;
+    }
+
+    if(!options.baseline.empty()){
+        std::vector<bench_result> baseline;
+        if(!ReadBaseline(options.baseline, baseline)){
+            return 1;
+        }
+        uint32_t regressions = CompareResults(options, results, baseline);
+        if(regressions > 0){
+            PrintToLog("WARNING: %u benchmarks regressed by more than %.0f%%!", regressions, options.threshold * 100.0);
+            return 2;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,123 @@
+#include "photon_sim.h"
+
+#include <physfs.h>
+#include <string>
+#include <sstream>
+#include <cstdlib>
+#include <cstring>
+
+using namespace photon;
+
+// writes a generated level file, the same options always give the same file:
+// photon_generate [options] <output file>
+
+void PrintUsage(const char *executable){
+    PrintToLog("usage: %s [options] <output file>", executable);
+    PrintToLog("    --seed <n>             (default 1)");
+    PrintToLog("    --size <width> <height> (default 64 64)");
+    PrintToLog("    --emitters <n>         (default 8)");
+    PrintToLog("    --colors <list>        comma separated emitter colors, white red green blue (default white)");
+    PrintToLog("    --mirrors <density>    chance of each block being a mirror (default 0.05)");
+    PrintToLog("    --filters <density>    chance of each block being a filter (default 0)");
+    PrintToLog("    --receivers <n>");
+    PrintToLog("    --targets <n>");
+    PrintToLog("    --tnt <clusters> <size>");
+    PrintToLog("    --moves <n>");
+    PrintToLog("    --mode <mode>          none, power, targets, destruction or tnt_harvester");
+    PrintToLog("    --goal <n>             TNT needed to win tnt_harvester levels");
+}
+
+bool ParseColors(const std::string &list, std::vector<block_type> &types){
+    types.clear();
+    std::stringstream stream(list);
+    std::string color;
+    while(std::getline(stream, color, ',')){
+        block_type type = blocks::GetBlockFromName(("emitter_" + color).c_str());
+        if(type == invalid_block){
+            PrintToLog("ERROR: unknown emitter color \"%s\"!", color.c_str());
+            return false;
+        }
+        types.push_back(type);
+    }
+    return !types.empty();
+}
+
+int main(int argc, char *argv[]){
+    photon_generator_settings settings;
+    std::string output;
+
+    for(int i = 1; i < argc; i++){
+        int values = argc - i - 1;
+        if(!strcmp(argv[i], "--seed") && values >= 1){
+            settings.seed = strtoull(argv[++i], nullptr, 10);
+        }else if(!strcmp(argv[i], "--size") && values >= 2){
+            settings.width = strtoul(argv[++i], nullptr, 10);
+            settings.height = strtoul(argv[++i], nullptr, 10);
+        }else if(!strcmp(argv[i], "--emitters") && values >= 1){
+            settings.emitters = strtoul(argv[++i], nullptr, 10);
+        }else if(!strcmp(argv[i], "--colors") && values >= 1){
+            if(!ParseColors(argv[++i], settings.emitter_types)){
+                return 1;
+            }
+        }else if(!strcmp(argv[i], "--mirrors") && values >= 1){
+            settings.mirror_density = atof(argv[++i]);
+        }else if(!strcmp(argv[i], "--filters") && values >= 1){
+            settings.filter_density = atof(argv[++i]);
+        }else if(!strcmp(argv[i], "--receivers") && values >= 1){
+            settings.receivers = strtoul(argv[++i], nullptr, 10);
+        }else if(!strcmp(argv[i], "--targets") && values >= 1){
+            settings.targets = strtoul(argv[++i], nullptr, 10);
+        }else if(!strcmp(argv[i], "--tnt") && values >= 2){
+            settings.tnt_clusters = strtoul(argv[++i], nullptr, 10);
+            settings.tnt_cluster_size = strtoul(argv[++i], nullptr, 10);
+        }else if(!strcmp(argv[i], "--moves") && values >= 1){
+            settings.move_blocks = strtoul(argv[++i], nullptr, 10);
+        }else if(!strcmp(argv[i], "--mode") && values >= 1){
+            settings.mode = level::GetModeFromName(argv[++i]);
+            if(settings.mode == photon_level::script){
+                PrintToLog("ERROR: can't generate script levels!");
+                return 1;
+            }
+        }else if(!strcmp(argv[i], "--goal") && values >= 1){
+            settings.goal = atoi(argv[++i]);
+        }else if(argv[i][0] != '-' && output.empty()){
+            output = argv[i];
+        }else{
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if(output.empty()){
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    // SaveLevelXML() writes through PhysFS, so write to the directory of the output file.
+    std::string directory = ".";
+    std::string filename = output;
+    size_t slash = output.find_last_of('/');
+    if(slash != std::string::npos){
+        directory = slash > 0 ? output.substr(0, slash) : "/";
+        filename = output.substr(slash + 1);
+    }
+
+    PHYSFS_init(argv[0]);
+    if(!PHYSFS_setWriteDir(directory.c_str())){
+        PrintToLog("ERROR: unable to write to \"%s\": %s", directory.c_str(), PHYSFS_getLastError());
+        PHYSFS_deinit();
+        return 1;
+    }
+
+    photon_level level;
+    photon_player player;
+
+    generator::Generate(settings, level, player);
+    level::SaveLevelXML(filename, level, player);
+
+    PrintToLog("INFO: wrote \"%s\" with %u blocks.", output.c_str(), level::GetBlockCount(level));
+
+    PHYSFS_deinit();
+
+    return 0;
+}
@@ -0,0 +1,64 @@
+#include "photon_sim.h"
+
+#include <physfs.h>
+#include <cstdlib>
+
+using namespace photon;
+
+// runs a level without a window: photon_simulate <data dir> <level file> [frames] [frame time] [trace file]
+int main(int argc, char *argv[]){
+    if(argc < 3){
+        PrintToLog("usage: %s <data dir> <level file> [frames (default 600)] [frame time (default 1/60)] [profiler trace file]", argv[0]);
+        return 1;
+    }
+    const char *data_dir = argv[1];
+    const char *filename = argv[2];
+    long frames = argc > 3 ? atol(argv[3]) : 600;
+    float frame_time = argc > 4 ? float(atof(argv[4])) : 1.0f / 60.0f;
+
+    if(frames < 0 || !(frame_time > 0.0f)){
+        PrintToLog("ERROR: frames must be positive and frame time greater than 0!");
+        return 1;
+    }
+
+    PHYSFS_init(argv[0]);
+    if(!PHYSFS_mount(data_dir, nullptr, 0)){
+        PrintToLog("ERROR: unable to mount data directory \"%s\": %s", data_dir, PHYSFS_getLastError());
+        PHYSFS_deinit();
+        return 1;
+    }
+
+    photon_level level;
+    photon_player player;
+
+    lua::InitLua(level, player);
+
+    if(!level::LoadLevelXML(filename, level, player)){
+        PHYSFS_deinit();
+        return 1;
+    }
+
+    long frame = 0;
+    for(; frame < frames; frame++){
+        level::AdvanceFrame(level, player, frame_time);
+
+        if(!level.is_valid){
+            break;
+        }
+    }
+
+    PrintToLog("INFO: simulated %li frames of \"%s\", victory state: %i time: %f moves: %u beams: %u blocks: %u",
+               frame, filename, int(level.victory_state), level.time, level.moves, uint32_t(level.beams.size()), level::GetBlockCount(level));
+
+    tracer::GarbageCollect();
+
+    if(argc > 5){
+        // relative to the current directory.
+        PHYSFS_setWriteDir(".");
+        profiler::WriteChromeTrace(argv[5]);
+    }
+
+    PHYSFS_deinit();
+
+    return 0;
+}